@@ -5,6 +5,8 @@
 #include "Logger.h"
 #include "Config.h"
 #include "MysqlPool.h"
+#include "StaticFileHandler.h"
+#include "RoomMessageHandler.h"
 
 int main() {
     Logger::init_minimal();
@@ -18,6 +20,40 @@ int main() {
     pool->getConn();
 
     NetBootstrap net;
+    // 聊天室：/join、/leave、/say
+    net.setMessageHandler(std::make_shared<RoomMessageHandler>(net.rooms()));
+
+    net.router()->get("/", [](const HttpRequest&, const RouteParams&, const HttpResponder& res) {
+        res.send(boost::beast::http::status::ok, "Hello HTTP");
+    });
+
+    // 各 worker loop 的连接数和延迟分布
+    net.router()->get("/debug/loops", [&net](const HttpRequest&, const RouteParams&, const HttpResponder& res) {
+        std::string body;
+        if (auto pool = net.loopPool()) {
+            for (const auto& loop : pool->loops()) {
+                body += "loop " + std::to_string(loop->index()) +
+                        " connections=" + std::to_string(loop->connectionCount()) +
+                        " lag_us=" + std::to_string(loop->stats().lastLagNs() / 1000) + "\n  " +
+                        LoopStats::format(loop->stats().snapshot()) + "\n";
+            }
+        }
+        res.send(boost::beast::http::status::ok, body);
+    });
+
+    // web 客户端静态资源
+    std::string staticRoot = Config::getString("static.root", "");
+    if (!staticRoot.empty()) {
+        StaticFileHandler::Options options;
+        options.root = staticRoot;
+        options.indexFile = Config::getString("static.index", "index.html");
+        options.maxCachedFileSize = Config::getInt("static.max_cached_file_size", 64 * 1024);
+        options.maxCacheBytes = Config::getInt("static.max_cache_bytes", 64 * 1024 * 1024);
+        options.revalidateMs = Config::getInt("static.revalidate_ms", 2000);
+        StaticFileHandler::mount(*net.router(), Config::getString("static.url_prefix", "/static"),
+                                 std::make_shared<StaticFileHandler>(options));
+    }
+
     net.start(Config::getInt("server.port", 9000));
 
     getchar();
@@ -0,0 +1,141 @@
+// 新连接接入吞吐：单个 Acceptor + worker 池（reuse_port=false）对比
+// 每个 worker loop 一个 SO_REUSEPORT Acceptor（reuse_port=true），接线方式与 NetBootstrap 相同。
+// 用法：accept_bench [single|reuseport] [loops=4] [clients=8] [seconds=5] [port=19000]
+// 客户端线程不停地 connect 后立即以 RST 关闭（SO_LINGER 0，本机不留 TIME_WAIT），
+// 以各 accept loop 统计到的 Accept 次数计算每秒接入数。
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Acceptor.h"
+#include "EventLoop.h"
+#include "EventLoopPool.h"
+#include "HttpRouter.h"
+#include "Logger.h"
+#include "ServerContext.h"
+
+namespace {
+uint64_t acceptCount(const std::vector<std::shared_ptr<EventLoop>>& loops) {
+    uint64_t total = 0;
+    for (const auto& loop : loops) {
+        total += loop->stats().snapshot().kinds[static_cast<size_t>(LoopStats::Kind::Accept)].count;
+    }
+    return total;
+}
+
+// 在 loop 线程上执行 fn 并等它完成（acceptor 只能在自己的 loop 线程上关闭）
+void runOn(const std::shared_ptr<EventLoop>& loop, std::function<void()> fn) {
+    std::promise<void> done;
+    loop->post([&] {
+        fn();
+        done.set_value();
+    });
+    done.get_future().wait();
+}
+
+void clientLoop(uint16_t port, const std::atomic<bool>& running, std::atomic<uint64_t>& failed) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const linger rst{1, 0};
+
+    while (running.load(std::memory_order_relaxed)) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            failed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &rst, sizeof(rst));
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        ::close(fd);
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "single";
+    size_t loopCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4;
+    size_t clients = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 5;
+    uint16_t port = static_cast<uint16_t>(argc > 5 ? std::atoi(argv[5]) : 19000);
+    bool reusePort = mode == "reuseport";
+
+    Logger::init_minimal();
+    Logger::get()->set_level(spdlog::level::err);
+
+    auto context = std::make_shared<ServerContext>();
+    context->router = std::make_shared<HttpRouter>();
+
+    auto acceptLoop = std::make_shared<EventLoop>(0);
+    auto pool = std::make_shared<EventLoopPool>(std::max<size_t>(loopCount, 1));
+
+    // 统计 Accept 的是 accept 所在的 loop：单 Acceptor 时是 acceptLoop，reuseport 时是各 worker
+    std::vector<std::shared_ptr<Acceptor>> acceptors;
+    std::vector<std::shared_ptr<EventLoop>> acceptLoops;
+    if (reusePort) {
+        for (const auto& loop : pool->loops()) {
+            acceptors.push_back(std::make_shared<Acceptor>(loop, port, context, nullptr, true));
+            acceptLoops.push_back(loop);
+        }
+    } else {
+        acceptors.push_back(std::make_shared<Acceptor>(acceptLoop, port, context, pool));
+        acceptLoops.push_back(acceptLoop);
+    }
+    for (auto& acceptor : acceptors) {
+        acceptor->startAccept();
+    }
+    pool->start();
+    acceptLoop->run();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> failed{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients; ++i) {
+        threads.emplace_back(clientLoop, port, std::cref(running), std::ref(failed));
+    }
+
+    // 预热一秒再计时
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    uint64_t before = acceptCount(acceptLoops);
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    uint64_t after = acceptCount(acceptLoops);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    running = false;
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::printf("mode=%s acceptors=%zu workers=%zu clients=%zu accepts=%llu accepts/sec=%.0f connect_failures=%llu\n",
+                mode.c_str(), acceptors.size(), pool->size(), clients,
+                static_cast<unsigned long long>(after - before), (after - before) / elapsed,
+                static_cast<unsigned long long>(failed.load()));
+    for (const auto& loop : acceptLoops) {
+        auto accept = loop->stats().snapshot().kinds[static_cast<size_t>(LoopStats::Kind::Accept)];
+        std::printf("  loop %zu: accepts=%llu mean_us=%.1f p99_us=%.1f\n", loop->index(),
+                    static_cast<unsigned long long>(accept.count), accept.meanNs() / 1000.0,
+                    accept.percentileNs(0.99) / 1000.0);
+    }
+
+    for (size_t i = 0; i < acceptors.size(); ++i) {
+        runOn(acceptLoops[i], [&acceptor = acceptors[i]] { acceptor->stop(); });
+    }
+    acceptLoop->stop();
+    pool->stop();
+    return 0;
+}
@@ -0,0 +1,211 @@
+// 连接读写循环吞吐：HTTP keep-alive 请求/应答和 WebSocket 回显的每秒往返次数。
+// 同一份代码分别以 -DENABLE_COROUTINES=OFF / ON 构建，对比回调链与协程两种读循环
+// （输出里的 model 字段标明当前构建）。服务端接线与 NetBootstrap 的单 Acceptor 模式相同，
+// 客户端每个线程一条阻塞连接，发一个请求等一个应答。
+// 用法：conn_throughput_bench [http|ws] [loops=2] [clients=16] [seconds=5] [port=19100]
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Acceptor.h"
+#include "EventLoop.h"
+#include "EventLoopPool.h"
+#include "HttpConnection.h"
+#include "HttpRouter.h"
+#include "Logger.h"
+#include "ServerContext.h"
+#include "WsMessageHandler.h"
+
+namespace {
+#ifdef NET_USE_COROUTINES
+constexpr const char* kModel = "coroutine";
+#else
+constexpr const char* kModel = "callback";
+#endif
+
+int connectTo(uint16_t port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readExact(int fd, std::string& buf, size_t len) {
+    char chunk[4096];
+    while (buf.size() < len) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+// 读到完整的 HTTP 头（及其后已到达的数据），返回头部长度；失败返回 0
+size_t readHeader(int fd, std::string& buf) {
+    char chunk[4096];
+    for (;;) {
+        size_t end = buf.find("\r\n\r\n");
+        if (end != std::string::npos) return end + 4;
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return 0;
+        buf.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+// 一个 keep-alive 连接上循环请求 /ping，返回完成的往返次数
+uint64_t httpClient(uint16_t port, const std::atomic<bool>& running) {
+    static const std::string request = "GET /ping HTTP/1.1\r\nHost: bench\r\n\r\n";
+    uint64_t done = 0;
+    int fd = connectTo(port);
+    std::string buf;
+    while (fd >= 0 && running.load(std::memory_order_relaxed)) {
+        if (!writeAll(fd, request.data(), request.size())) break;
+        size_t header = readHeader(fd, buf);
+        if (header == 0) break;
+        size_t length = 0;
+        size_t pos = buf.find("Content-Length: ");
+        if (pos != std::string::npos && pos < header) {
+            length = std::strtoul(buf.c_str() + pos + 16, nullptr, 10);
+        }
+        if (!readExact(fd, buf, header + length)) break;
+        buf.erase(0, header + length);
+        ++done;
+    }
+    if (fd >= 0) ::close(fd);
+    return done;
+}
+
+// 升级为 WebSocket 后循环发送文本帧，等回显，返回完成的往返次数
+uint64_t wsClient(uint16_t port, const std::atomic<bool>& running) {
+    static const std::string upgrade =
+        "GET /ws HTTP/1.1\r\nHost: bench\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    static const std::string payload = "hello from the connection throughput benchmark";
+
+    // 客户端帧必须加掩码；掩码取 0，payload 原样
+    std::string frame;
+    frame.push_back(static_cast<char>(0x81));
+    frame.push_back(static_cast<char>(0x80 | payload.size()));
+    frame.append(4, '\0');
+    frame.append(payload);
+
+    uint64_t done = 0;
+    int fd = connectTo(port);
+    std::string buf;
+    if (fd < 0 || !writeAll(fd, upgrade.data(), upgrade.size())) {
+        if (fd >= 0) ::close(fd);
+        return 0;
+    }
+    size_t header = readHeader(fd, buf);
+    if (header == 0 || buf.compare(0, 12, "HTTP/1.1 101") != 0) {
+        ::close(fd);
+        return 0;
+    }
+    buf.erase(0, header);
+
+    while (running.load(std::memory_order_relaxed)) {
+        if (!writeAll(fd, frame.data(), frame.size())) break;
+        if (!readExact(fd, buf, 2)) break;
+        size_t length = static_cast<unsigned char>(buf[1]) & 0x7f;
+        size_t offset = 2;
+        if (length == 126) {
+            if (!readExact(fd, buf, 4)) break;
+            length = (static_cast<unsigned char>(buf[2]) << 8) | static_cast<unsigned char>(buf[3]);
+            offset = 4;
+        }
+        if (!readExact(fd, buf, offset + length)) break;
+        buf.erase(0, offset + length);
+        ++done;
+    }
+    ::close(fd);
+    return done;
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "http";
+    size_t loopCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2;
+    size_t clients = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 16;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 5;
+    uint16_t port = static_cast<uint16_t>(argc > 5 ? std::atoi(argv[5]) : 19100);
+    bool ws = mode == "ws";
+
+    Logger::init_minimal();
+    Logger::get()->set_level(spdlog::level::err);
+
+    // 计时期间不因 keep-alive 上限或空闲超时断开
+    HttpConnection::KeepAliveOptions keepAlive;
+    keepAlive.idleTimeoutMs = 60000;
+    keepAlive.maxRequests = std::numeric_limits<size_t>::max();
+    HttpConnection::setKeepAliveOptions(keepAlive);
+
+    auto context = std::make_shared<ServerContext>();
+    context->router = std::make_shared<HttpRouter>();
+    context->router->get("/ping", [](const HttpRequest&, const RouteParams&, const HttpResponder& res) {
+        res.send(boost::beast::http::status::ok, "pong");
+    });
+    context->wsHandler = std::make_shared<EchoMessageHandler>();
+
+    auto acceptLoop = std::make_shared<EventLoop>(0);
+    auto pool = std::make_shared<EventLoopPool>(std::max<size_t>(loopCount, 1));
+    auto acceptor = std::make_shared<Acceptor>(acceptLoop, port, context, pool);
+    acceptor->startAccept();
+    pool->start();
+    acceptLoop->run();
+
+    std::atomic<bool> running{true};
+    std::atomic<uint64_t> total{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < clients; ++i) {
+        threads.emplace_back([&] {
+            total.fetch_add(ws ? wsClient(port, running) : httpClient(port, running));
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    running = false;
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("model=%s mode=%s workers=%zu clients=%zu round_trips=%llu %.0f round_trips/sec\n",
+                kModel, mode.c_str(), pool->size(), clients,
+                static_cast<unsigned long long>(total.load()), total.load() / elapsed);
+
+    acceptor->stop();
+    acceptLoop->stop();
+    pool->stop();
+    return 0;
+}
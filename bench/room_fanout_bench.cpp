@@ -0,0 +1,112 @@
+// 房间扇出基准：每个 loop 上放同样多的订阅者，从非 loop 线程向房间连续发布，
+// 统计每秒送达多少条消息（接收者 × 消息数）。订阅者是只计数的空连接，
+// 测的是 Room::publish 的快照 + 每 loop 一个批量任务的扇出路径，不含 socket 写。
+// 用法：room_fanout_bench [loops=4] [deliveries_per_size=20000000] [sizes=10,100,1000,10000,50000]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Connection.h"
+#include "EventLoopPool.h"
+#include "Logger.h"
+#include "MessageBuffer.h"
+#include "Room.h"
+
+namespace {
+// 只在所属 loop 线程上被 send，计数不需要原子操作
+class CountingConnection : public Connection {
+public:
+    using Connection::Connection;
+    using Connection::send;
+
+    void send(MessageBuffer::Ptr) override { ++m_received; }
+    std::string remoteAddr() const override { return "bench"; }
+    void close() override {}
+    void start() override {}
+
+    uint64_t received() const { return m_received; }
+
+private:
+    uint64_t m_received = 0;
+};
+
+// 每个 loop 上的任务按投递顺序执行：排一个空任务并等它跑完，之前的扇出任务就都执行完了
+void drain(EventLoopPool& pool) {
+    std::vector<std::future<void>> done;
+    for (const auto& loop : pool.loops()) {
+        auto promise = std::make_shared<std::promise<void>>();
+        done.push_back(promise->get_future());
+        loop->post([promise] { promise->set_value(); });
+    }
+    for (auto& f : done) {
+        f.wait();
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    size_t loopCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    size_t deliveries = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20000000;
+    std::vector<size_t> sizes = {10, 100, 1000, 10000, 50000};
+    if (argc > 3) {
+        sizes.clear();
+        std::stringstream list(argv[3]);
+        for (std::string item; std::getline(list, item, ',');) {
+            sizes.push_back(std::strtoul(item.c_str(), nullptr, 10));
+        }
+    }
+
+    Logger::init_minimal();
+    Logger::get()->set_level(spdlog::level::err);
+
+    EventLoopPool pool(std::max<size_t>(loopCount, 1));
+    pool.start();
+
+    auto msg = MessageBuffer::make("[bench] hello from the room fan-out benchmark");
+    std::printf("loops=%zu\n", pool.size());
+    for (size_t size : sizes) {
+        size = std::max<size_t>(size, 1);
+        auto room = std::make_shared<Room>("bench");
+        std::vector<std::shared_ptr<CountingConnection>> members;
+        members.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            auto conn = std::make_shared<CountingConnection>(pool.getNextLoop());
+            room->join(conn);
+            members.push_back(std::move(conn));
+        }
+
+        // 预热一次：第一次发布时才建快照
+        room->publish(msg);
+        drain(pool);
+
+        size_t messages = std::max<size_t>(deliveries / size, 10);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < messages; ++i) {
+            room->publish(msg);
+        }
+        drain(pool);
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        uint64_t received = 0;
+        for (const auto& conn : members) {
+            received += conn->received();
+        }
+        uint64_t expected = static_cast<uint64_t>(messages + 1) * size;
+        std::printf("  room_size=%-6zu messages=%-8zu %12.0f deliveries/sec %10.0f publishes/sec%s\n",
+                    size, messages, messages * size / sec, messages / sec,
+                    received == expected ? "" : "  (MISSING DELIVERIES)");
+
+        // 连接在 loop 线程之外析构只改连接计数，这里直接释放
+        for (const auto& conn : members) {
+            room->leave(conn.get());
+        }
+    }
+
+    pool.stop();
+    return 0;
+}
@@ -0,0 +1,129 @@
+// SessionManager 多线程基准，分三段：
+//   create：各线程并发创建 Session
+//   get   ：各线程并发按随机 id 查找（分片读锁路径）
+//   sweep ：一个线程像 NetBootstrap 的定时任务那样反复 sweepExpired 回收一半已过期的 Session，
+//           其余线程同时查找另一半，统计回收速度、单次 sweep 最长耗时和并发查找吞吐
+// 用法：session_manager_bench [threads=4] [sessions=200000] [gets_per_thread=1000000] [sweep_batch=1024]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+#include "SessionManager.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <class F>
+double runThreads(size_t threads, F&& body) {
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(body, t);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    return secondsSince(start);
+}
+}
+
+int main(int argc, char* argv[]) {
+    size_t threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+    size_t sessions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    size_t getsPerThread = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000000;
+    size_t sweepBatch = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1024;
+    threads = std::max<size_t>(threads, 2);
+    sessions = std::max<size_t>(sessions, threads * 2);
+
+    Logger::init_minimal();
+    Logger::get()->set_level(spdlog::level::err);
+
+    SessionManager::Options options;
+    options.secret = "bench";
+    options.defaultTtlMs = 60000;       // 计时期间不会自然过期，sweep 段单独把一半设成立即过期
+    options.sweepBatch = sweepBatch;
+    SessionManager manager(options);
+
+    // ---- create ----
+    std::vector<std::vector<uint64_t>> created(threads);
+    size_t perThread = sessions / threads;
+    double createSec = runThreads(threads, [&](size_t t) {
+        auto& ids = created[t];
+        ids.reserve(perThread);
+        for (size_t i = 0; i < perThread; ++i) {
+            ids.push_back(manager.createSession()->id());
+        }
+    });
+    std::vector<uint64_t> ids;
+    for (const auto& part : created) {
+        ids.insert(ids.end(), part.begin(), part.end());
+    }
+    std::printf("threads=%zu sessions=%zu\n", threads, ids.size());
+    std::printf("  create: %.0f ops/sec\n", ids.size() / createSec);
+
+    // ---- get ----
+    std::atomic<uint64_t> hits{0};
+    double getSec = runThreads(threads, [&](size_t t) {
+        std::mt19937_64 rng(t + 1);
+        uint64_t local = 0;
+        for (size_t i = 0; i < getsPerThread; ++i) {
+            local += manager.getSession(ids[rng() % ids.size()]) != nullptr;
+        }
+        hits.fetch_add(local);
+    });
+    std::printf("  get:    %.0f ops/sec (hits %llu/%zu)\n", threads * getsPerThread / getSec,
+                static_cast<unsigned long long>(hits.load()), threads * getsPerThread);
+
+    // ---- sweep：偶数下标的 Session 立即过期，奇数下标的继续被查找 ----
+    std::vector<uint64_t> live;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i % 2 == 0) {
+            manager.getSession(ids[i])->setTtl(1);
+        } else {
+            live.push_back(ids[i]);
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    std::atomic<bool> sweeping{true};
+    std::atomic<uint64_t> sweepGets{0};
+    size_t removed = 0, calls = 0;
+    double maxCallUs = 0, sweepSec = 0;
+    double mixedSec = runThreads(threads, [&](size_t t) {
+        if (t == 0) {
+            auto start = Clock::now();
+            size_t target = ids.size() - live.size();
+            while (removed < target) {
+                auto callStart = Clock::now();
+                removed += manager.sweepExpired();
+                maxCallUs = std::max(maxCallUs, secondsSince(callStart) * 1e6);
+                ++calls;
+            }
+            sweepSec = secondsSince(start);
+            sweeping = false;
+            return;
+        }
+        std::mt19937_64 rng(t + 100);
+        uint64_t local = 0;
+        while (sweeping.load(std::memory_order_relaxed)) {
+            manager.getSession(live[rng() % live.size()]);
+            ++local;
+        }
+        sweepGets.fetch_add(local);
+    });
+    std::printf("  sweep:  removed=%zu in %zu calls, %.0f sessions/sec, max call %.0f us (batch %zu)\n",
+                removed, calls, removed / sweepSec, maxCallUs, sweepBatch);
+    std::printf("          concurrent get: %.0f ops/sec on %zu threads, remaining sessions=%zu\n",
+                sweepGets.load() / mixedSec, threads - 1, manager.size());
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "MysqlConn.h"
 #include "Logger.h"
+#include <algorithm>
 
 MysqlConn::MysqlConn() {
     // 初始化
@@ -18,6 +19,7 @@ MysqlConn::MysqlConn() {
 }
 
 MysqlConn::~MysqlConn() {
+    clearStmts();   // 语句句柄要在连接关闭之前释放
     if (m_conn != nullptr) {
         LOG_DEBUG("Closing MySQL connection");
         mysql_close(m_conn);
@@ -129,6 +131,51 @@ std::string MysqlConn::value(int index) {
     return std::string(val, length);
 }
 
+MysqlStmt* MysqlConn::prepare(const std::string& sql) {
+    auto it = m_stmts.find(sql);
+    if (it != m_stmts.end()) {
+        if ((*it->second)->valid()) {
+            // 🔑 命中：移到链表头，不再发给服务端解析
+            m_stmtLru.splice(m_stmtLru.begin(), m_stmtLru, it->second);
+            return m_stmtLru.front().get();
+        }
+        // 连接断过，旧句柄已失效，丢掉后重新 prepare
+        m_stmtLru.erase(it->second);
+        m_stmts.erase(it);
+    }
+
+    auto stmt = std::make_unique<MysqlStmt>(m_conn, sql);
+    if (!stmt->valid()) {
+        return nullptr;
+    }
+
+    while (m_stmtLru.size() >= m_stmtCacheSize) {
+        LOG_DEBUG("Evicting cached statement - SQL: {}", m_stmtLru.back()->sql());
+        m_stmts.erase(m_stmtLru.back()->sql());
+        m_stmtLru.pop_back();
+    }
+    m_stmtLru.push_front(std::move(stmt));
+    m_stmts.emplace(m_stmtLru.front()->sql(), m_stmtLru.begin());
+    return m_stmtLru.front().get();
+}
+
+void MysqlConn::setStmtCacheSize(size_t size) {
+    m_stmtCacheSize = std::max<size_t>(size, 1);
+    while (m_stmtLru.size() > m_stmtCacheSize) {
+        m_stmts.erase(m_stmtLru.back()->sql());
+        m_stmtLru.pop_back();
+    }
+}
+
+size_t MysqlConn::stmtCacheCount() const {
+    return m_stmtLru.size();
+}
+
+void MysqlConn::clearStmts() {
+    m_stmts.clear();
+    m_stmtLru.clear();
+}
+
 bool MysqlConn::transaction() {
     LOG_DEBUG("Starting transaction");
     if (mysql_autocommit(m_conn, false) != 0) {
@@ -145,6 +192,7 @@ bool MysqlConn::commit() {
         LOG_ERROR("Failed to commit transaction: {}", mysql_error(m_conn));
         return false;
     }
+    mysql_autocommit(m_conn, true);
     LOG_DEBUG("Transaction committed");
     return true;
 }
@@ -155,6 +203,7 @@ bool MysqlConn::rollback() {
         LOG_ERROR("Failed to rollback transaction: {}", mysql_error(m_conn));
         return false;
     }
+    mysql_autocommit(m_conn, true);
     LOG_DEBUG("Transaction rolled back");
     return true;
 }
@@ -3,6 +3,12 @@
 #include <iostream>
 #include <mysql/mysql.h>
 #include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "MysqlStmt.h"
 
 class MysqlConn {
 public:
@@ -20,11 +26,17 @@ public:
     bool next();
     // 得到结果集中的字段值
     std::string value(int index);
+    // 预处理语句：按 SQL 文本缓存在本连接上（LRU），同一条 SQL 只在第一次时发给服务端解析。
+    // 失败返回 nullptr；返回的语句归连接所有，只在下一次 prepare 之前保证有效
+    MysqlStmt* prepare(const std::string& sql);
+    // 缓存的语句数上限，超出时关闭最久没用的（默认 64，至少为 1）
+    void setStmtCacheSize(size_t size);
+    size_t stmtCacheCount() const;
     // 事务操作
     bool transaction();
-    // 提交事务
+    // 提交事务（之后恢复自动提交，连接归还池后不影响其他使用者）
     bool commit();
-    // 事务回滚
+    // 事务回滚（同上）
     bool rollback();
     
     // 刷新起始空闲时刻
@@ -34,8 +46,14 @@ public:
 
 private:
     void freeResult();  // 释放m_result对应空间
+    void clearStmts();
     MYSQL* m_conn = nullptr;
     MYSQL_RES* m_result = nullptr;
     MYSQL_ROW m_row = nullptr;
     std::chrono::steady_clock::time_point m_aliveTime;
+
+    // 语句缓存：链表头是最近用过的，map 的 key 指向语句自己持有的 SQL 文本
+    std::list<std::unique_ptr<MysqlStmt>> m_stmtLru;
+    std::unordered_map<std::string_view, std::list<std::unique_ptr<MysqlStmt>>::iterator> m_stmts;
+    size_t m_stmtCacheSize = 64;
 };
\ No newline at end of file
@@ -0,0 +1,289 @@
+#include "MysqlStmt.h"
+#include "Logger.h"
+#include <charconv>
+#include <cstring>
+
+namespace {
+// 这些错误之后语句句柄已不可用，必须在（重连后的）连接上重新 prepare
+bool isFatal(unsigned int err) {
+    return err == 2006      // CR_SERVER_GONE_ERROR
+        || err == 2013      // CR_SERVER_LOST
+        || err == 1243;     // ER_UNKNOWN_STMT_HANDLER
+}
+
+bool isIntegerType(enum_field_types type) {
+    return type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_LONG ||
+           type == MYSQL_TYPE_INT24 || type == MYSQL_TYPE_LONGLONG;
+}
+
+constexpr size_t kInitialColumnBytes = 256;
+}
+
+MysqlStmt::MysqlStmt(MYSQL* conn, std::string sql) : m_sql(std::move(sql)) {
+    m_stmt = mysql_stmt_init(conn);
+    if (m_stmt == nullptr) {
+        LOG_ERROR("mysql_stmt_init failed: {}", mysql_error(conn));
+        return;
+    }
+
+    if (mysql_stmt_prepare(m_stmt, m_sql.data(), static_cast<unsigned long>(m_sql.size())) != 0) {
+        LOG_ERROR("MySQL prepare failed: {} - SQL: {}", mysql_stmt_error(m_stmt), m_sql);
+        return;
+    }
+
+    size_t params = mysql_stmt_param_count(m_stmt);
+    m_params.resize(params);
+    m_paramBinds.resize(params);
+    // 没绑定过的参数按 NULL 发送，而不是全零的 MYSQL_BIND（类型 0 是 DECIMAL，缓冲区却为空）
+    for (size_t i = 0; i < params; ++i) {
+        std::memset(&m_paramBinds[i], 0, sizeof(MYSQL_BIND));
+        m_params[i].isNull = true;
+        m_paramBinds[i].buffer_type = MYSQL_TYPE_NULL;
+        m_paramBinds[i].is_null = &m_params[i].isNull;
+    }
+
+    setupResult();
+    m_valid = true;
+    LOG_DEBUG("Statement prepared, params: {}, fields: {} - SQL: {}", params, m_fields.size(), m_sql);
+}
+
+MysqlStmt::~MysqlStmt() {
+    if (m_stmt != nullptr) {
+        freeResult();
+        mysql_stmt_close(m_stmt);
+    }
+}
+
+void MysqlStmt::setupResult() {
+    MYSQL_RES* meta = mysql_stmt_result_metadata(m_stmt);
+    if (meta == nullptr) {
+        return;     // INSERT/UPDATE 等没有结果集
+    }
+
+    unsigned int count = mysql_num_fields(meta);
+    MYSQL_FIELD* defs = mysql_fetch_fields(meta);
+    m_fields.resize(count);
+    m_resultBinds.resize(count);
+
+    // 🔑 结果缓冲区在 prepare 时一次建好，之后每行 fetch 直接写进去，不再逐行分配
+    for (unsigned int i = 0; i < count; ++i) {
+        Field& f = m_fields[i];
+        MYSQL_BIND& bind = m_resultBinds[i];
+        std::memset(&bind, 0, sizeof(MYSQL_BIND));
+        f.integer = isIntegerType(defs[i].type);
+        if (f.integer) {
+            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+            bind.buffer = &f.value;
+            bind.buffer_length = sizeof(f.value);
+        } else {
+            f.buffer.resize(kInitialColumnBytes);
+            bind.buffer_type = MYSQL_TYPE_STRING;
+            bind.buffer = f.buffer.data();
+            bind.buffer_length = static_cast<unsigned long>(f.buffer.size());
+        }
+        bind.length = &f.length;
+        bind.is_null = &f.isNull;
+        bind.error = &f.error;
+    }
+    mysql_free_result(meta);
+}
+
+bool MysqlStmt::valid() const {
+    return m_valid;
+}
+
+const std::string& MysqlStmt::sql() const {
+    return m_sql;
+}
+
+size_t MysqlStmt::paramCount() const {
+    return m_params.size();
+}
+
+size_t MysqlStmt::fieldCount() const {
+    return m_fields.size();
+}
+
+bool MysqlStmt::checkParam(size_t index) const {
+    if (index >= m_params.size()) {
+        LOG_WARN("Parameter index out of range: {} (total params: {})", index, m_params.size());
+        return false;
+    }
+    return true;
+}
+
+void MysqlStmt::bindInt(size_t index, int64_t value) {
+    if (!checkParam(index)) return;
+    Param& p = m_params[index];
+    p.integer = value;
+    p.isNull = false;
+
+    MYSQL_BIND& bind = m_paramBinds[index];
+    bind.buffer_type = MYSQL_TYPE_LONGLONG;
+    bind.buffer = &p.integer;
+    bind.is_unsigned = false;
+    bind.is_null = &p.isNull;
+    bind.length = nullptr;
+}
+
+void MysqlStmt::bindUInt(size_t index, uint64_t value) {
+    bindInt(index, static_cast<int64_t>(value));
+    if (index < m_paramBinds.size()) {
+        m_paramBinds[index].is_unsigned = true;
+    }
+}
+
+void MysqlStmt::bindString(size_t index, std::string_view value) {
+    if (!checkParam(index)) return;
+    Param& p = m_params[index];
+    p.text.assign(value.data(), value.size());
+    p.length = static_cast<unsigned long>(p.text.size());
+    p.isNull = false;
+
+    MYSQL_BIND& bind = m_paramBinds[index];
+    bind.buffer_type = MYSQL_TYPE_STRING;
+    bind.buffer = p.text.data();
+    bind.buffer_length = p.length;
+    bind.length = &p.length;
+    bind.is_null = &p.isNull;
+}
+
+void MysqlStmt::bindNull(size_t index) {
+    if (!checkParam(index)) return;
+    m_params[index].isNull = true;
+
+    MYSQL_BIND& bind = m_paramBinds[index];
+    bind.buffer_type = MYSQL_TYPE_NULL;
+    bind.is_null = &m_params[index].isNull;
+}
+
+bool MysqlStmt::execute() {
+    if (!m_valid) {
+        LOG_WARN("execute() called on an invalid statement - SQL: {}", m_sql);
+        return false;
+    }
+
+    freeResult();
+
+    if (!m_paramBinds.empty() && mysql_stmt_bind_param(m_stmt, m_paramBinds.data())) {
+        fail("bind param");
+        return false;
+    }
+    if (mysql_stmt_execute(m_stmt) != 0) {
+        fail("execute");
+        return false;
+    }
+
+    if (!m_fields.empty()) {
+        if (mysql_stmt_bind_result(m_stmt, m_resultBinds.data()) || mysql_stmt_store_result(m_stmt) != 0) {
+            fail("store result");
+            return false;
+        }
+        m_hasResult = true;
+    }
+    return true;
+}
+
+uint64_t MysqlStmt::affectedRows() const {
+    return m_stmt ? mysql_stmt_affected_rows(m_stmt) : 0;
+}
+
+uint64_t MysqlStmt::insertId() const {
+    return m_stmt ? mysql_stmt_insert_id(m_stmt) : 0;
+}
+
+bool MysqlStmt::next() {
+    if (!m_hasResult) {
+        LOG_WARN("next() called but statement has no result set - SQL: {}", m_sql);
+        return false;
+    }
+
+    int rc = mysql_stmt_fetch(m_stmt);
+    if (rc == MYSQL_NO_DATA) {
+        return false;
+    }
+    if (rc == 1) {
+        fail("fetch");
+        return false;
+    }
+
+    if (rc == MYSQL_DATA_TRUNCATED) {
+        // 字符串列比缓冲区长：按实际长度扩容后单独取回这一列，之后的行直接复用大缓冲区
+        for (size_t i = 0; i < m_fields.size(); ++i) {
+            Field& f = m_fields[i];
+            if (f.integer || !f.error) continue;
+
+            f.buffer.resize(f.length);
+            MYSQL_BIND& bind = m_resultBinds[i];
+            bind.buffer = f.buffer.data();
+            bind.buffer_length = static_cast<unsigned long>(f.buffer.size());
+            if (mysql_stmt_fetch_column(m_stmt, &bind, static_cast<unsigned int>(i), 0) != 0) {
+                fail("fetch column");
+                return false;
+            }
+            f.error = false;
+        }
+        // 更新后的缓冲区地址要重新绑定，下一次 fetch 才会写进去
+        mysql_stmt_bind_result(m_stmt, m_resultBinds.data());
+    }
+    return true;
+}
+
+const MysqlStmt::Field* MysqlStmt::field(int index) const {
+    if (index < 0 || static_cast<size_t>(index) >= m_fields.size()) {
+        LOG_WARN("Column index out of range: {} (total columns: {})", index, m_fields.size());
+        return nullptr;
+    }
+    return &m_fields[index];
+}
+
+bool MysqlStmt::isNull(int index) const {
+    const Field* f = field(index);
+    return f == nullptr || f->isNull;
+}
+
+int64_t MysqlStmt::getInt(int index) const {
+    const Field* f = field(index);
+    if (f == nullptr || f->isNull) {
+        return 0;
+    }
+    if (f->integer) {
+        return f->value;
+    }
+
+    int64_t value = 0;
+    std::from_chars(f->buffer.data(), f->buffer.data() + f->length, value);
+    return value;
+}
+
+std::string_view MysqlStmt::getView(int index) const {
+    const Field* f = field(index);
+    if (f == nullptr || f->isNull || f->integer) {
+        return {};
+    }
+    return std::string_view(f->buffer.data(), f->length);
+}
+
+std::string MysqlStmt::getString(int index) const {
+    const Field* f = field(index);
+    if (f != nullptr && f->integer && !f->isNull) {
+        return std::to_string(f->value);
+    }
+    return std::string(getView(index));
+}
+
+void MysqlStmt::freeResult() {
+    if (m_hasResult) {
+        mysql_stmt_free_result(m_stmt);
+        m_hasResult = false;
+    }
+}
+
+void MysqlStmt::fail(const char* what) {
+    unsigned int err = mysql_stmt_errno(m_stmt);
+    LOG_ERROR("MySQL statement {} failed: {} ({}) - SQL: {}", what, mysql_stmt_error(m_stmt), err, m_sql);
+    if (isFatal(err)) {
+        m_valid = false;
+    }
+    mysql_stmt_reset(m_stmt);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <mysql/mysql.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// 服务端预处理语句（mysql_stmt_*）：SQL 只解析一次，参数和结果走二进制协议，
+// 不再拼接 SQL、也不需要转义。通常通过 MysqlConn::prepare 取得（带缓存），不直接构造。
+// 用法：
+//   MysqlStmt* stmt = conn->prepare("SELECT id, content FROM messages WHERE channel=? LIMIT ?");
+//   if (stmt && (stmt->bindString(0, channel), stmt->bindInt(1, 50), stmt->execute())) {
+//       while (stmt->next()) { int64_t id = stmt->getInt(0); std::string_view s = stmt->getView(1); }
+//   }
+// - 参数值在 bind 时拷贝进语句自己的缓冲区，execute 之前调用方的数据可以随时释放
+// - 整数列按 LONGLONG 绑定，其余列按字符串绑定；getView 返回的视图在下一次 next/execute 前有效
+// - 非线程安全，和所属的 MysqlConn 一样同一时刻只能由一个线程使用
+class MysqlStmt {
+public:
+    MysqlStmt(MYSQL* conn, std::string sql);
+    ~MysqlStmt();
+
+    MysqlStmt(const MysqlStmt&) = delete;
+    MysqlStmt& operator=(const MysqlStmt&) = delete;
+
+    // 预处理失败或连接已断开（需要重新 prepare）时为 false
+    bool valid() const;
+    const std::string& sql() const;
+    size_t paramCount() const;
+    size_t fieldCount() const;
+
+    // ---- 参数绑定，下标从 0 开始 ----
+    void bindInt(size_t index, int64_t value);
+    void bindUInt(size_t index, uint64_t value);
+    void bindString(size_t index, std::string_view value);
+    void bindNull(size_t index);
+
+    // 执行；有结果集时整体取回客户端，之后用 next 遍历
+    bool execute();
+    uint64_t affectedRows() const;
+    uint64_t insertId() const;
+
+    // ---- 结果集 ----
+    bool next();
+    bool isNull(int index) const;
+    int64_t getInt(int index) const;
+    std::string getString(int index) const;
+    std::string_view getView(int index) const;
+
+private:
+    // MYSQL_BIND 里 is_null / error 指向的类型：MySQL 8 是 bool，MariaDB 和旧版 MySQL 是 my_bool（char）
+    using NullFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+    using ErrorFlag = std::remove_pointer_t<decltype(MYSQL_BIND::error)>;
+
+    struct Param {
+        int64_t integer = 0;
+        std::string text;
+        unsigned long length = 0;
+        NullFlag isNull = false;
+    };
+
+    struct Field {
+        bool integer = false;
+        int64_t value = 0;
+        std::vector<char> buffer;
+        unsigned long length = 0;
+        NullFlag isNull = false;
+        ErrorFlag error = false;
+    };
+
+    bool checkParam(size_t index) const;
+    const Field* field(int index) const;
+    void setupResult();
+    void freeResult();
+    void fail(const char* what);
+
+    MYSQL_STMT* m_stmt = nullptr;
+    std::string m_sql;
+    bool m_valid = false;
+    bool m_hasResult = false;
+
+    std::vector<Param> m_params;
+    std::vector<MYSQL_BIND> m_paramBinds;
+    std::vector<Field> m_fields;
+    std::vector<MYSQL_BIND> m_resultBinds;
+};
@@ -0,0 +1,224 @@
+#include "WriteBehind.h"
+#include "MysqlPool.h"
+#include "MysqlConn.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+
+WriteBehind::WriteBehind(MysqlPool* pool, Options options)
+    : m_pool(pool),
+      m_options(std::move(options)),
+      m_queue(std::max<size_t>(m_options.queueCapacity, 2)) {
+    if (m_options.writers == 0) m_options.writers = 1;
+    // 一条预处理语句最多 65535 个占位符
+    size_t maxRows = 65535 / std::max<size_t>(m_options.columns.size(), 1);
+    m_options.batchRows = std::clamp<size_t>(m_options.batchRows, 1, maxRows);
+
+    std::string prefix = "INSERT INTO " + m_options.table + " (";
+    std::string row = "(";
+    for (size_t i = 0; i < m_options.columns.size(); ++i) {
+        if (i) {
+            prefix += ',';
+            row += ',';
+        }
+        prefix += m_options.columns[i];
+        row += '?';
+    }
+    prefix += ") VALUES ";
+    row += ')';
+
+    auto insertSql = [&](size_t rows) {
+        std::string sql = prefix;
+        sql.reserve(prefix.size() + rows * (row.size() + 1));
+        for (size_t i = 0; i < rows; ++i) {
+            if (i) sql += ',';
+            sql += row;
+        }
+        return sql;
+    };
+    m_insertSql.emplace_back(m_options.batchRows, insertSql(m_options.batchRows));
+    for (size_t rows = size_t(1) << (63 - __builtin_clzll(m_options.batchRows)); rows > 0; rows >>= 1) {
+        if (rows < m_options.batchRows) {
+            m_insertSql.emplace_back(rows, insertSql(rows));
+        }
+    }
+
+    for (size_t i = 0; i < m_options.writers; ++i) {
+        m_writers.emplace_back(&WriteBehind::writerLoop, this, i);
+    }
+    LOG_INFO("Write-behind started, table={}, writers={}, batch={}, interval={}ms, capacity={}",
+             m_options.table, m_options.writers, m_options.batchRows,
+             m_options.flushIntervalMs, m_queue.capacity());
+}
+
+WriteBehind::~WriteBehind() {
+    // 🔑 先拒绝新的写入，再等已经越过检查的生产者入队完成，最后才让写线程排空退出；
+    //    否则越过检查的那一行可能在写线程退出后才入队，永远不会落库也不会回调
+    m_stopping.store(true);
+    while (m_producers.load() != 0) {
+        std::this_thread::yield();
+    }
+    m_closed.store(true, std::memory_order_release);
+    m_cv.notify_all();
+    for (auto& t : m_writers) {
+        if (t.joinable()) t.join();
+    }
+    LOG_INFO("Write-behind stopped, table={}, written={}, failed={}",
+             m_options.table, m_written.load(), m_failed.load());
+}
+
+bool WriteBehind::write(std::vector<std::string> values, Callback done, ExecutorPtr executor) {
+    // 先登记再检查 m_stopping（都是 seq_cst）：析构要么被这里看到，要么等到这里返回
+    m_producers.fetch_add(1);
+    struct Leave {
+        std::atomic<size_t>& producers;
+        ~Leave() { producers.fetch_sub(1); }
+    } leave{m_producers};
+
+    if (values.size() != m_options.columns.size() || m_stopping.load()) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 先计数再入队：写线程减掉的永远不会多于已计入的，计数不会下溢
+    size_t queued = m_queued.fetch_add(1, std::memory_order_relaxed) + 1;
+    Item item{std::move(values), std::move(done), std::move(executor)};
+    if (!m_queue.push(std::move(item))) {
+        m_queued.fetch_sub(1, std::memory_order_relaxed);
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+    // 🔑 只在攒满一批时唤醒写线程，平时由写线程按 flushIntervalMs 自己醒来，
+    // 生产者路径上没有锁也没有系统调用
+    if (queued == m_options.batchRows) {
+        m_cv.notify_one();
+    }
+    return true;
+}
+
+void WriteBehind::writerLoop(size_t index) {
+    LOG_INFO("Write-behind writer {} started", index);
+
+    std::vector<Item> batch;
+    batch.reserve(m_options.batchRows);
+    const auto interval = std::chrono::milliseconds(m_options.flushIntervalMs);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, interval, [this] {
+                return m_closed.load(std::memory_order_acquire) ||
+                       m_queued.load(std::memory_order_relaxed) >= m_options.batchRows;
+            });
+        }
+
+        // 一次醒来把能取的整批都写完，积压时不再等待
+        for (;;) {
+            Item item;
+            while (batch.size() < m_options.batchRows && m_queue.pop(item)) {
+                batch.push_back(std::move(item));
+            }
+            if (batch.empty()) break;
+
+            m_queued.fetch_sub(batch.size(), std::memory_order_relaxed);
+            bool ok = flushBatch(batch);
+            complete(batch, ok);
+            batch.clear();
+        }
+
+        if (m_closed.load(std::memory_order_acquire) &&
+            m_queued.load(std::memory_order_relaxed) == 0) {
+            break;
+        }
+    }
+
+    LOG_INFO("Write-behind writer {} stopped", index);
+}
+
+bool WriteBehind::flushBatch(std::vector<Item>& batch) {
+    for (size_t attempt = 0; attempt <= m_options.maxRetries; ++attempt) {
+        if (attempt > 0) {
+            // 数据库卡住时退避；这期间队列继续积压，满了由 write 拒绝
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_options.retryBackoffMs * attempt));
+        }
+
+        auto conn = m_pool->getConn();
+        if (!conn) continue;
+
+        // 整批一个事务：要么全部写入，要么全部重试
+        bool ok = conn->transaction() && insertRows(*conn, batch) && conn->commit();
+        if (ok) {
+            m_written.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        conn->rollback();
+        LOG_WARN("Write-behind batch failed, table={}, rows={}, attempt={}",
+                 m_options.table, batch.size(), attempt + 1);
+    }
+
+    m_failed.fetch_add(batch.size(), std::memory_order_relaxed);
+    LOG_ERROR("Write-behind batch dropped after retries, table={}, rows={}", m_options.table, batch.size());
+    return false;
+}
+
+bool WriteBehind::insertRows(MysqlConn& conn, const std::vector<Item>& batch) {
+    size_t done = 0;
+    while (done < batch.size()) {
+        // 🔑 取不超过剩余行数的最大语句；语句已在连接上缓存时不再发给服务端解析
+        size_t remaining = batch.size() - done;
+        auto it = std::find_if(m_insertSql.begin(), m_insertSql.end(),
+            [remaining](const auto& entry) { return entry.first <= remaining; });
+        MysqlStmt* stmt = conn.prepare(it->second);
+        if (!stmt) return false;
+
+        size_t param = 0;
+        for (size_t i = done; i < done + it->first; ++i) {
+            for (const auto& value : batch[i].values) {
+                stmt->bindString(param++, value);
+            }
+        }
+        if (!stmt->execute()) return false;
+        done += it->first;
+    }
+    return true;
+}
+
+void WriteBehind::complete(std::vector<Item>& batch, bool ok) {
+    // 按 Executor 分组：同一个 loop 上的回调合并成一个任务
+    std::vector<std::pair<ExecutorPtr, std::vector<Callback>>> groups;
+    for (auto& item : batch) {
+        if (!item.done) continue;
+
+        if (!item.executor) {
+            item.done(ok);
+            continue;
+        }
+        auto it = std::find_if(groups.begin(), groups.end(),
+            [&](const auto& g) { return g.first == item.executor; });
+        if (it == groups.end()) {
+            groups.emplace_back(item.executor, std::vector<Callback>{});
+            it = groups.end() - 1;
+        }
+        it->second.push_back(std::move(item.done));
+    }
+
+    for (auto& [executor, callbacks] : groups) {
+        (*executor)([callbacks = std::move(callbacks), ok] {
+            for (const auto& cb : callbacks) cb(ok);
+        });
+    }
+}
+
+WriteBehind::Stats WriteBehind::stats() const {
+    Stats s;
+    s.enqueued = m_enqueued.load(std::memory_order_relaxed);
+    s.rejected = m_rejected.load(std::memory_order_relaxed);
+    s.written = m_written.load(std::memory_order_relaxed);
+    s.failed = m_failed.load(std::memory_order_relaxed);
+    s.batches = m_batches.load(std::memory_order_relaxed);
+    s.queued = m_queued.load(std::memory_order_relaxed);
+    return s;
+}
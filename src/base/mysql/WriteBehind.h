@@ -0,0 +1,97 @@
+#pragma once
+
+#include "MpmcQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MysqlPool;
+class MysqlConn;
+
+// 写后（write-behind）持久化：业务线程（EventLoop）只把一行数据放进无锁有界队列就返回，
+// 少量写线程从 MysqlPool 取连接，攒够 batchRows 行或等满 flushIntervalMs 后，
+// 在一个事务里用预处理的多行 INSERT 写入，一次提交覆盖整批。
+// - 完成回调投递回调用方指定的 Executor（通常是发起写入的 EventLoop），
+//   同一批里同一个 Executor 的回调合并成一次投递
+// - 数据库卡住时写线程按退避重试，队列写满后 write 直接返回 false，内存有上界
+// - 满批用一条 batchRows 行的语句；不满一批时拆成几条 2 的幂行数的语句，
+//   每个连接上最多 log2(batchRows)+2 条不同的 SQL，都留在 MysqlConn 的语句缓存里
+// - 所有值按字符串绑定（二进制协议，不拼接也不转义），由 MySQL 按列类型转换
+class WriteBehind {
+public:
+    using Executor = std::function<void(std::function<void()>)>;
+    using ExecutorPtr = std::shared_ptr<const Executor>;
+    using Callback = std::function<void(bool ok)>;
+
+    struct Options {
+        std::string table;
+        std::vector<std::string> columns;
+        size_t writers = 2;
+        size_t batchRows = 256;             // 每个事务最多写多少行
+        uint64_t flushIntervalMs = 20;      // 不满一批时最多等多久
+        size_t queueCapacity = 65536;
+        size_t maxRetries = 3;
+        uint64_t retryBackoffMs = 100;
+    };
+
+    struct Stats {
+        uint64_t enqueued = 0;
+        uint64_t rejected = 0;      // 队列满或列数不符
+        uint64_t written = 0;
+        uint64_t failed = 0;        // 重试耗尽后放弃的行
+        uint64_t batches = 0;
+        uint64_t queued = 0;
+    };
+
+    WriteBehind(MysqlPool* pool, Options options);
+    // 停止接收新数据，写完队列中剩余的行后退出
+    ~WriteBehind();
+
+    WriteBehind(const WriteBehind&) = delete;
+    WriteBehind& operator=(const WriteBehind&) = delete;
+
+    // values 与 options.columns 一一对应。返回 false 时不会调用 done。
+    // executor 为空时回调在写线程上执行
+    bool write(std::vector<std::string> values, Callback done = nullptr, ExecutorPtr executor = nullptr);
+
+    Stats stats() const;
+
+private:
+    struct Item {
+        std::vector<std::string> values;
+        Callback done;
+        ExecutorPtr executor;
+    };
+
+    void writerLoop(size_t index);
+    bool flushBatch(std::vector<Item>& batch);
+    bool insertRows(MysqlConn& conn, const std::vector<Item>& batch);
+    void complete(std::vector<Item>& batch, bool ok);
+
+    MysqlPool* m_pool;
+    Options m_options;
+    // 按行数从大到小：batchRows 行，以及小于它的各个 2 的幂行数的 "INSERT ... VALUES (?,?),(?,?)..."
+    std::vector<std::pair<size_t, std::string>> m_insertSql;
+    MpmcQueue<Item> m_queue;
+
+    std::atomic<size_t> m_queued{0};
+    std::atomic<uint64_t> m_enqueued{0};
+    std::atomic<uint64_t> m_rejected{0};
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_failed{0};
+    std::atomic<uint64_t> m_batches{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<bool> m_stopping{false};    // 析构开始：拒绝新的写入
+    std::atomic<size_t> m_producers{0};     // 正在 write 里的生产者数
+    std::atomic<bool> m_closed{false};      // 生产者都已离开：写线程排空后退出
+    std::vector<std::thread> m_writers;
+};
@@ -0,0 +1,472 @@
+#include "OfflineLog.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t kRecordMagic = 0x4C474F31;   // "1OGL"
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t length;        // payload 字节数
+    uint32_t type;
+    uint32_t checksum;      // 覆盖 userId、seq、type 和 payload，识别写了一半的记录
+    uint64_t userId;
+    uint64_t seq;
+};
+
+static_assert(sizeof(RecordHeader) == 32, "record header layout");
+
+size_t recordSize(size_t payload) {
+    return (sizeof(RecordHeader) + payload + 7) & ~size_t(7);
+}
+
+uint32_t fnv1a(const void* data, size_t len, uint32_t h = 2166136261u) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t checksumOf(const RecordHeader& h, const void* payload) {
+    uint32_t sum = fnv1a(&h.userId, sizeof(h.userId));
+    sum = fnv1a(&h.seq, sizeof(h.seq), sum);
+    sum = fnv1a(&h.type, sizeof(h.type), sum);
+    return fnv1a(payload, h.length, sum);
+}
+
+std::string segmentPath(const std::string& dir, size_t shard, uint64_t number) {
+    return dir + "/shard-" + std::to_string(shard) + "-" + std::to_string(number) + ".log";
+}
+}
+
+struct OfflineLog::Segment {
+    uint64_t number = 0;
+    std::string path;
+    unsigned char* base = nullptr;
+    size_t size = 0;
+    size_t writeOffset = 0;
+    size_t flushedOffset = 0;
+    size_t records = 0;     // 含 Ack
+    size_t live = 0;        // 尚未消费的消息
+
+    ~Segment() {
+        if (base) {
+            ::munmap(base, size);
+        }
+    }
+};
+
+OfflineLog::OfflineLog(Options options) : m_options(std::move(options)) {
+    if (m_options.shards == 0) m_options.shards = 1;
+    m_options.segmentBytes = std::max<size_t>(m_options.segmentBytes, 64 * 1024);
+    // 单条记录（含头部和对齐）必须放得进一个段
+    m_options.maxPayloadBytes = std::min(m_options.maxPayloadBytes,
+                                         m_options.segmentBytes - sizeof(RecordHeader) - 8);
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_options.dir, ec);
+    if (ec) {
+        LOG_ERROR("offline log dir create failed, dir={}, err={}", m_options.dir, ec.message());
+    }
+
+    for (size_t i = 0; i < m_options.shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        recover(*shard);
+        m_shards.push_back(std::move(shard));
+    }
+
+    LOG_INFO("Offline log opened, dir={}, shards={}, pending={}",
+             m_options.dir, m_options.shards, m_pending.load());
+
+    m_flusher = std::thread(&OfflineLog::flusherLoop, this);
+}
+
+OfflineLog::~OfflineLog() {
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        m_stopping = true;
+    }
+    m_flushCv.notify_all();
+    if (m_flusher.joinable()) {
+        m_flusher.join();
+    }
+    flush();
+}
+
+OfflineLog::Shard& OfflineLog::shardFor(uint64_t userId) {
+    return *m_shards[(userId * 0x9E3779B97F4A7C15ull >> 32) % m_shards.size()];
+}
+
+const OfflineLog::Shard& OfflineLog::shardFor(uint64_t userId) const {
+    return *m_shards[(userId * 0x9E3779B97F4A7C15ull >> 32) % m_shards.size()];
+}
+
+std::shared_ptr<OfflineLog::Segment> OfflineLog::openSegment(Shard& shard, uint64_t segmentNo, bool create) {
+    auto segment = std::make_shared<Segment>();
+    segment->number = segmentNo;
+    segment->path = segmentPath(m_options.dir, shard.index, segmentNo);
+
+    int flags = O_RDWR | O_CLOEXEC | (create ? O_CREAT | O_TRUNC : 0);
+    int fd = ::open(segment->path.c_str(), flags, 0600);
+    if (fd < 0) {
+        LOG_ERROR("offline segment open failed, path={}, err={}", segment->path, std::strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    if (create && ::ftruncate(fd, static_cast<off_t>(m_options.segmentBytes)) != 0) {
+        LOG_ERROR("offline segment ftruncate failed, path={}, err={}", segment->path, std::strerror(errno));
+        ::close(fd);
+        return nullptr;
+    }
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    segment->size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("offline segment mmap failed, path={}, err={}", segment->path, std::strerror(errno));
+        return nullptr;
+    }
+    segment->base = static_cast<unsigned char*>(base);
+    return segment;
+}
+
+void OfflineLog::recover(Shard& shard) {
+    // 找出本分片的所有段，按段号排序
+    std::string prefix = "shard-" + std::to_string(shard.index) + "-";
+    std::vector<uint64_t> numbers;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(m_options.dir, ec)) {
+        std::string name = file.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) == 0 && file.path().extension() == ".log") {
+            numbers.push_back(std::strtoull(name.c_str() + prefix.size(), nullptr, 10));
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+
+    for (uint64_t number : numbers) {
+        auto segment = openSegment(shard, number, false);
+        if (!segment) continue;
+
+        // 顺序扫描到第一条无效记录为止（段尾的零或崩溃时写了一半的记录）
+        size_t offset = 0;
+        while (offset + sizeof(RecordHeader) <= segment->size) {
+            RecordHeader header;
+            std::memcpy(&header, segment->base + offset, sizeof(header));
+            const unsigned char* payload = segment->base + offset + sizeof(header);
+            if (header.magic != kRecordMagic ||
+                header.length > segment->size - offset - sizeof(header) ||
+                header.checksum != checksumOf(header, payload)) {
+                break;
+            }
+
+            ++segment->records;
+            shard.nextSeq = std::max(shard.nextSeq, header.seq + 1);
+            if (header.type == static_cast<uint32_t>(RecordType::Message)) {
+                ++segment->live;
+                shard.users[header.userId].push_back(Entry{header.seq, segment, offset});
+            } else if (header.type == static_cast<uint32_t>(RecordType::Ack)) {
+                auto it = shard.users.find(header.userId);
+                if (it != shard.users.end()) {
+                    auto& entries = it->second;
+                    auto keep = std::remove_if(entries.begin(), entries.end(), [&](const Entry& e) {
+                        if (e.seq > header.seq) return false;
+                        --e.segment->live;
+                        return true;
+                    });
+                    entries.erase(keep, entries.end());
+                }
+            }
+            offset += recordSize(header.length);
+        }
+
+        segment->writeOffset = offset;
+        segment->flushedOffset = offset;
+        shard.segments.push_back(std::move(segment));
+    }
+
+    // 压缩搬移过的记录可能排在后面，按序号恢复顺序
+    size_t pending = 0;
+    for (auto it = shard.users.begin(); it != shard.users.end();) {
+        auto& entries = it->second;
+        if (entries.empty()) {
+            it = shard.users.erase(it);
+            continue;
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+        pending += entries.size();
+        ++it;
+    }
+    m_pending.fetch_add(pending, std::memory_order_relaxed);
+
+    if (shard.segments.empty()) {
+        if (auto segment = openSegment(shard, 1, true)) {
+            shard.segments.push_back(std::move(segment));
+        }
+    }
+}
+
+bool OfflineLog::appendLocked(Shard& shard, RecordType type, uint64_t userId, uint64_t seq,
+                              std::string_view payload, Entry* where) {
+    if (shard.segments.empty()) {
+        return false;
+    }
+
+    size_t need = recordSize(payload.size());
+    std::shared_ptr<Segment> segment = shard.segments.back();
+    if (segment->writeOffset + need > segment->size) {
+        auto next = openSegment(shard, segment->number + 1, true);
+        if (!next) {
+            return false;
+        }
+        shard.segments.push_back(next);
+        segment = std::move(next);
+    }
+
+    RecordHeader header;
+    header.magic = kRecordMagic;
+    header.length = static_cast<uint32_t>(payload.size());
+    header.type = static_cast<uint32_t>(type);
+    header.userId = userId;
+    header.seq = seq;
+    header.checksum = checksumOf(header, payload.data());
+
+    // 🔑 只是写进映射内存，落盘交给后台批量 msync
+    unsigned char* dst = segment->base + segment->writeOffset;
+    if (!payload.empty()) {
+        std::memcpy(dst + sizeof(header), payload.data(), payload.size());
+    }
+    std::memcpy(dst, &header, sizeof(header));
+
+    if (where) {
+        *where = Entry{seq, segment, segment->writeOffset};
+    }
+    segment->writeOffset += need;
+    ++segment->records;
+    if (type == RecordType::Message) {
+        ++segment->live;
+    }
+    return true;
+}
+
+void OfflineLog::ackLocked(Shard& shard, uint64_t userId, uint64_t seq) {
+    if (!appendLocked(shard, RecordType::Ack, userId, seq, {}, nullptr)) {
+        LOG_WARN("offline ack append failed, uid={}, seq={}", userId, seq);
+    }
+}
+
+bool OfflineLog::append(uint64_t userId, std::string_view payload) {
+    if (payload.size() > m_options.maxPayloadBytes) {
+        LOG_WARN("offline message too large, uid={}, bytes={}", userId, payload.size());
+        return false;
+    }
+
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    Entry entry;
+    uint64_t seq = shard.nextSeq++;
+    if (!appendLocked(shard, RecordType::Message, userId, seq, payload, &entry)) {
+        return false;
+    }
+
+    auto& entries = shard.users[userId];
+    entries.push_back(std::move(entry));
+    m_appended.fetch_add(1, std::memory_order_relaxed);
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    // 每用户上限：丢弃最早的一条，并记一条 Ack 让它重启后也不再出现
+    if (entries.size() > m_options.maxMessagesPerUser) {
+        uint64_t droppedSeq = entries.front().seq;
+        --entries.front().segment->live;
+        entries.pop_front();
+        ackLocked(shard, userId, droppedSeq);
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+std::vector<OfflineLog::Message> OfflineLog::peek(uint64_t userId, size_t maxMessages, size_t maxBytes) const {
+    std::vector<Message> messages;
+
+    const Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.users.find(userId);
+    if (it == shard.users.end()) {
+        return messages;
+    }
+
+    size_t bytes = 0;
+    for (const Entry& e : it->second) {
+        if (messages.size() >= maxMessages) {
+            break;
+        }
+        RecordHeader header;
+        std::memcpy(&header, e.segment->base + e.offset, sizeof(header));
+        if (header.length > maxBytes - bytes) {
+            break;
+        }
+        bytes += header.length;
+        messages.push_back(Message{e.seq, std::string(reinterpret_cast<const char*>(
+            e.segment->base + e.offset + sizeof(header)), header.length)});
+    }
+    return messages;
+}
+
+size_t OfflineLog::ack(uint64_t userId, uint64_t upToSeq) {
+    Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.users.find(userId);
+    if (it == shard.users.end()) {
+        return 0;
+    }
+
+    // peek 之后被每用户上限丢掉的消息已经不在队首，这里只会确认仍在的那部分
+    auto& entries = it->second;
+    size_t n = 0;
+    while (n < entries.size() && entries[n].seq <= upToSeq) {
+        --entries[n].segment->live;
+        ++n;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    entries.erase(entries.begin(), entries.begin() + n);
+    if (entries.empty()) {
+        shard.users.erase(it);
+    }
+    ackLocked(shard, userId, upToSeq);
+
+    m_drained.fetch_add(n, std::memory_order_relaxed);
+    m_pending.fetch_sub(n, std::memory_order_relaxed);
+    return n;
+}
+
+size_t OfflineLog::pending(uint64_t userId) const {
+    const Shard& shard = shardFor(userId);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.users.find(userId);
+    return it != shard.users.end() ? it->second.size() : 0;
+}
+
+void OfflineLog::flush() {
+    struct Range {
+        std::shared_ptr<Segment> segment;   // 持有段，期间被压缩删除也不会 munmap
+        size_t from;
+        size_t to;
+    };
+    std::vector<Range> ranges;
+
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto& segment : shard->segments) {
+            if (segment->writeOffset > segment->flushedOffset) {
+                ranges.push_back(Range{segment, segment->flushedOffset, segment->writeOffset});
+                segment->flushedOffset = segment->writeOffset;
+            }
+        }
+    }
+
+    // 🔑 锁外批量 msync：一次刷盘覆盖这段时间内的所有追加
+    static const size_t kPage = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    for (const auto& r : ranges) {
+        size_t from = r.from & ~(kPage - 1);
+        if (::msync(r.segment->base + from, r.to - from, MS_SYNC) != 0) {
+            LOG_ERROR("offline log msync failed, path={}, err={}", r.segment->path, std::strerror(errno));
+        }
+    }
+}
+
+bool OfflineLog::compactLocked(Shard& shard) {
+    if (shard.segments.size() < 2) {
+        return false;
+    }
+
+    std::shared_ptr<Segment> oldest = shard.segments.front();
+    if (oldest->live > 0 &&
+        static_cast<double>(oldest->live) >= m_options.compactLiveRatio * static_cast<double>(oldest->records)) {
+        return false;
+    }
+
+    // 存活记录原样（同一序号）搬到当前段末尾，索引指向新位置
+    if (oldest->live > 0) {
+        for (auto& [userId, entries] : shard.users) {
+            for (auto& e : entries) {
+                if (e.segment != oldest) continue;
+
+                RecordHeader header;
+                std::memcpy(&header, e.segment->base + e.offset, sizeof(header));
+                std::string_view payload(reinterpret_cast<const char*>(e.segment->base + e.offset + sizeof(header)),
+                                         header.length);
+                Entry moved;
+                if (!appendLocked(shard, RecordType::Message, userId, e.seq, payload, &moved)) {
+                    return false;
+                }
+                --oldest->live;
+                e = std::move(moved);
+            }
+        }
+    }
+
+    shard.segments.pop_front();
+    ::unlink(oldest->path.c_str());
+    m_compacted.fetch_add(1, std::memory_order_relaxed);
+    LOG_DEBUG("offline segment compacted, path={}", oldest->path);
+    return true;
+}
+
+size_t OfflineLog::compact() {
+    size_t removed = 0;
+    for (auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        while (compactLocked(*shard)) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+OfflineLog::Stats OfflineLog::stats() const {
+    Stats s;
+    s.appended = m_appended.load(std::memory_order_relaxed);
+    s.drained = m_drained.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    s.pending = m_pending.load(std::memory_order_relaxed);
+    s.compactedSegments = m_compacted.load(std::memory_order_relaxed);
+    for (const auto& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.segments += shard->segments.size();
+    }
+    return s;
+}
+
+void OfflineLog::flusherLoop() {
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+    while (!m_stopping) {
+        m_flushCv.wait_for(lock, std::chrono::milliseconds(m_options.flushIntervalMs));
+        if (m_stopping) break;
+
+        lock.unlock();
+        flush();
+        compact();
+        lock.lock();
+    }
+}
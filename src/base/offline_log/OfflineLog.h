@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 离线消息日志：用户不在线时消息先落到本地，重连时整批取出直接发给新连接，不经过 MySQL。
+//
+// - 按 user id 散列成若干分片，每个分片是一串定长段文件（dir/shard-<分片>-<段号>.log），
+//   只追加写，段文件整体 mmap，追加就是一次 memcpy，不做系统调用
+// - 内存索引：user id -> 该用户未取走消息的位置（按序号排序），启动时扫描段文件重建
+// - 投递分两步：peek 只读出消息（带序号），确认真正发出去之后再 ack；
+//   ack 和超出每用户上限的丢弃都写一条 Ack 记录："序号 <= N 的都已消费"，重启后不会重新投递。
+//   peek 之后、ack 之前断线的消息留在日志里，下次登录重发（至少一次）
+// - 刷盘批量进行：后台线程每 flushIntervalMs 对新写入的范围 msync 一次，
+//   崩溃最多丢失最近一个间隔内的消息
+// - 压缩：后台线程从最老的段开始，存活比例低于阈值时把存活记录搬到当前段末尾后删除整段；
+//   只删最老的段，保证 Ack 记录不会早于它所确认的消息被删掉
+// 所有方法线程安全；append / peek / ack 只持有所在分片的锁，耗时与消息大小成正比。
+class OfflineLog {
+public:
+    struct Options {
+        std::string dir = "offline";
+        size_t shards = 16;
+        size_t segmentBytes = 16 * 1024 * 1024;
+        uint64_t flushIntervalMs = 200;
+        double compactLiveRatio = 0.25;         // 最老段存活记录比例低于此值时压缩
+        size_t maxMessagesPerUser = 1000;       // 超出后丢弃该用户最早的消息
+        size_t maxPayloadBytes = 64 * 1024;
+    };
+
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t drained = 0;           // 已确认投递
+        uint64_t dropped = 0;           // 超出每用户上限被丢弃
+        uint64_t pending = 0;           // 当前未取走的消息数
+        uint64_t segments = 0;
+        uint64_t compactedSegments = 0;
+    };
+
+    explicit OfflineLog(Options options);
+    ~OfflineLog();
+
+    OfflineLog(const OfflineLog&) = delete;
+    OfflineLog& operator=(const OfflineLog&) = delete;
+
+    // 追加一条消息；payload 过大或磁盘错误时返回 false
+    bool append(uint64_t userId, std::string_view payload);
+
+    struct Message {
+        uint64_t seq;
+        std::string payload;
+    };
+
+    // 按写入顺序读出该用户最早的消息，不超过 maxMessages 条、payload 合计不超过 maxBytes；
+    // 不标记为已消费，发送成功后用最后一条的 seq 调 ack
+    std::vector<Message> peek(uint64_t userId,
+                              size_t maxMessages = std::numeric_limits<size_t>::max(),
+                              size_t maxBytes = std::numeric_limits<size_t>::max()) const;
+
+    // 把该用户序号 <= upToSeq 的消息标记为已消费，返回本次确认的条数
+    size_t ack(uint64_t userId, uint64_t upToSeq);
+
+    size_t pending(uint64_t userId) const;
+
+    // 立即刷盘 / 压缩（后台线程也会定期调用）
+    void flush();
+    size_t compact();
+
+    Stats stats() const;
+
+private:
+    struct Segment;
+    struct Entry {
+        uint64_t seq;
+        std::shared_ptr<Segment> segment;
+        uint64_t offset;
+    };
+    struct Shard {
+        mutable std::mutex mutex;
+        size_t index = 0;
+        uint64_t nextSeq = 1;
+        std::deque<std::shared_ptr<Segment>> segments;      // 按段号递增，最后一个是当前写入段
+        std::unordered_map<uint64_t, std::deque<Entry>> users;
+    };
+
+    enum class RecordType : uint32_t { Message = 1, Ack = 2 };
+
+    Shard& shardFor(uint64_t userId);
+    const Shard& shardFor(uint64_t userId) const;
+
+    void recover(Shard& shard);
+    std::shared_ptr<Segment> openSegment(Shard& shard, uint64_t segmentNo, bool create);
+    // 在当前段追加一条记录，空间不够时换新段；返回记录位置
+    bool appendLocked(Shard& shard, RecordType type, uint64_t userId, uint64_t seq,
+                      std::string_view payload, Entry* where);
+    void ackLocked(Shard& shard, uint64_t userId, uint64_t seq);
+    bool compactLocked(Shard& shard);
+
+    void flusherLoop();
+
+    Options m_options;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    std::atomic<uint64_t> m_appended{0};
+    std::atomic<uint64_t> m_drained{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_pending{0};
+    std::atomic<uint64_t> m_compacted{0};
+
+    std::mutex m_flushMutex;
+    std::condition_variable m_flushCv;
+    bool m_stopping = false;
+    std::thread m_flusher;
+};
@@ -2,13 +2,41 @@
 #include "Acceptor.h"
 #include "Logger.h"
 #include <iostream>
+#include <sys/socket.h>
+
+namespace {
+using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+// fd / 内核内存耗尽后隔多久再 accept
+constexpr uint64_t kResourceRetryMs = 100;
+
+bool isResourceExhausted(const boost::system::error_code& ec) {
+    return ec == boost::asio::error::no_descriptors                        // EMFILE
+        || ec == boost::system::errc::too_many_files_open_in_system        // ENFILE
+        || ec == boost::asio::error::no_buffer_space                       // ENOBUFS
+        || ec == boost::asio::error::no_memory;                            // ENOMEM
+}
+}
 
 Acceptor::Acceptor(std::shared_ptr<EventLoop> loop, uint16_t port,
-                   std::shared_ptr<SessionManager> sessionManager)
+                   std::shared_ptr<ServerContext> context,
+                   std::shared_ptr<EventLoopPool> workers,
+                   bool reusePort)
     : m_loop(loop),
-      m_acceptor(loop->getIOContext(), boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port)),
-      m_sessionManager(sessionManager) {
-    LOG_INFO("Created on port {}", port);
+      m_acceptor(loop->getIOContext()),
+      m_context(context),
+      m_workers(workers) {
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
+    m_acceptor.open(endpoint.protocol());
+    m_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    if (reusePort) {
+        m_acceptor.set_option(reuse_port(true));
+    }
+    m_acceptor.bind(endpoint);
+    m_acceptor.listen();
+
+    LOG_INFO("Created on port {}, loop={}, workers={}, reuse_port={}",
+             port, loop->index(), m_workers ? m_workers->size() : 0, reusePort);
 }
 
 void Acceptor::startAccept() {
@@ -18,6 +46,7 @@ void Acceptor::startAccept() {
 
 void Acceptor::stop() {
     LOG_INFO("stop called");
+    m_stopped.store(true, std::memory_order_release);
     boost::system::error_code ec;
     m_acceptor.close(ec);
     if(ec) {
@@ -28,21 +57,51 @@ void Acceptor::stop() {
 void Acceptor::doAccept() {
     LOG_DEBUG("doAccept called");
 
+    // 🔑 socket 直接创建在 worker loop 的 io_context 上，之后的 IO 都在 worker 线程执行
+    auto worker = m_workers ? m_workers->getNextLoop() : m_loop;
+    auto self = shared_from_this();
+
     m_acceptor.async_accept(
-        [this](boost::system::error_code ec,
-                     boost::asio::ip::tcp::socket socket) {
+        worker->getIOContext(),
+        [self, worker](boost::system::error_code ec,
+                       boost::asio::ip::tcp::socket socket) {
+            LoopStatsScope scope(self->m_loop->stats(), LoopStats::Kind::Accept);
 
             if (ec) {
+                if (ec == boost::asio::error::operation_aborted
+                    || self->m_stopped.load(std::memory_order_acquire)) {
+                    return;     // stop() 关闭了 acceptor
+                }
                 LOG_ERROR("accept error: {}", ec.message());
+
+                // 🔑 出错后必须继续 accept：分片模式下内核仍按哈希把新连接分给这个 socket，
+                //    不再 accept 的话这一片的连接会一直堆在 backlog 里
+                if (isResourceExhausted(ec)) {
+                    // fd 耗尽时立刻重试只会空转，等已有连接释放资源后再试
+                    self->m_loop->runAfter(kResourceRetryMs, [self] {
+                        if (!self->m_stopped.load(std::memory_order_acquire)) {
+                            self->doAccept();
+                        }
+                    });
+                } else {
+                    self->doAccept();   // ECONNABORTED 等只影响这一个连接
+                }
                 return;
             }
 
-            LOG_INFO("new connection from {}",
-                     socket.remote_endpoint().address().to_string());
+            // 对端可能在 accept 完成前就已 RST，remote_endpoint 要用不抛异常的重载
+            boost::system::error_code peerEc;
+            auto peer = socket.remote_endpoint(peerEc);
+            LOG_INFO("new connection from {}, loop={}",
+                     peerEc ? std::string("unknown") : peer.address().to_string(),
+                     worker->index());
 
-            auto conn = std::make_shared<HttpConnection>(std::move(socket));
-            conn->start();
-            doAccept();
+            // 连接对象从 worker loop 的内存池分配，断开后内存留给下一个连接复用
+            auto conn = std::allocate_shared<HttpConnection>(
+                PoolAllocator<HttpConnection>(worker->memoryPool()),
+                std::move(socket), worker, self->m_context);
+            worker->post([conn] { conn->start(); });
+            self->doAccept();
         }
     );
-}
\ No newline at end of file
+}
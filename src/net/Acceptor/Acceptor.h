@@ -2,16 +2,24 @@
 #pragma once
 #include <boost/asio.hpp>
 #include <memory>
+#include <atomic>
 #include "EventLoop.h"
+#include "EventLoopPool.h"
 #include "Session.h"
 #include "SessionManager.h"
 #include "HttpConnection.h"
 #include "WebSocketConnection.h"
+#include "ServerContext.h"
 
 class Acceptor : public std::enable_shared_from_this<Acceptor> {
 public:
+    // loop: accept 所在的 loop；workers: 新连接分配到的 worker loop 池，
+    //       为空时连接留在 accept 所在的 loop 上（分片模式）
+    // reusePort: 设置 SO_REUSEPORT，允许多个 Acceptor 监听同一端口，由内核分发新连接
     Acceptor(std::shared_ptr<EventLoop> loop, uint16_t port,
-             std::shared_ptr<SessionManager> sessionManager);
+             std::shared_ptr<ServerContext> context,
+             std::shared_ptr<EventLoopPool> workers,
+             bool reusePort = false);
 
     void startAccept();
     void stop();
@@ -22,5 +30,7 @@ private:
 private:
     std::shared_ptr<EventLoop> m_loop;
     boost::asio::ip::tcp::acceptor m_acceptor;
-    std::shared_ptr<SessionManager> m_sessionManager;
+    std::shared_ptr<ServerContext> m_context;
+    std::shared_ptr<EventLoopPool> m_workers;
+    std::atomic<bool> m_stopped{false};     // stop() 可能在其他线程调用
 };
@@ -1,4 +1,21 @@
 #include "Connection.h"
+#include "PresenceIndex.h"
+
+Connection::Connection(std::shared_ptr<EventLoop> loop)
+    : m_loop(std::move(loop))
+{
+    if(m_loop) m_loop->addConnection();
+}
+
+Connection::~Connection()
+{
+    if(m_loop) m_loop->removeConnection();
+}
+
+void Connection::send(const std::string &data)
+{
+    send(MessageBuffer::make(data));
+}
 
 void Connection::bindSession(const std::shared_ptr<Session> &session)
 {
@@ -9,7 +26,27 @@ void Connection::bindSession(const std::shared_ptr<Session> &session)
     session->attach(shared_from_this());
 }
 
+void Connection::sendBatch(std::vector<MessageBuffer::Ptr> msgs)
+{
+    for(auto& msg : msgs) {
+        send(std::move(msg));
+    }
+}
+
 std::shared_ptr<Session> Connection::getSession() const
 {
     return m_session.lock();
 }
+
+void Connection::detachSession()
+{
+    if(auto session = m_session.lock()) {
+        session->detach(shared_from_this());
+    }
+    m_session.reset();
+}
+
+const std::shared_ptr<EventLoop>& Connection::loop() const
+{
+    return m_loop;
+}
@@ -2,23 +2,43 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "Session.h"
+#include "EventLoop.h"
+#include "MessageBuffer.h"
+#include "HandlerAllocator.h"
+#include <boost/beast/core/flat_buffer.hpp>
 
 class Session;
 
 class Connection : public std::enable_shared_from_this<Connection>{
 public:
     using Ptr = std::shared_ptr<Connection>;
-    virtual ~Connection() = default;
+    // 读缓冲区，内存来自所属 loop 的 MemoryPool
+    using Buffer = boost::beast::basic_flat_buffer<PoolAllocator<char>>;
 
-    virtual void send(const std::string& data) = 0;
+    // loop: 该连接所属的 EventLoop，连接的所有 IO 都在这个 loop 线程上执行
+    explicit Connection(std::shared_ptr<EventLoop> loop);
+    virtual ~Connection();
+
+    // 拷贝一份 data 后发送
+    void send(const std::string& data);
+    // 零拷贝发送：多个连接可共享同一个 MessageBuffer（广播）
+    virtual void send(MessageBuffer::Ptr msg) = 0;
+    // 一次交给连接一批消息（按顺序发送）；默认逐条 send，WebSocket 连接只跨线程投递一次
+    virtual void sendBatch(std::vector<MessageBuffer::Ptr> msgs);
     virtual std::string remoteAddr() const = 0;
     virtual void close() = 0;
     virtual void start() = 0;
 
     void bindSession(const std::shared_ptr<Session>& session);
     std::shared_ptr<Session> getSession() const;
+    // 从 Session 上摘下本连接；Session 没有连接后进入重连宽限期
+    void detachSession();
+
+    const std::shared_ptr<EventLoop>& loop() const;
 
 protected:
     std::weak_ptr<Session> m_session;
-};
\ No newline at end of file
+    std::shared_ptr<EventLoop> m_loop;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/core/role.hpp>
+#include <boost/beast/websocket/teardown.hpp>
+#include <cstddef>
+#include <utility>
+
+// WebSocketConnection 的下一层流：tcp::socket 外加一道写闸门。
+// 连接把排队的多条消息自己编码成帧后一次 gather 写进 socket，这次写绕过了 beast 的写锁；
+// 写的期间 beast 发起的写（自动回复的 pong、ping、close 帧）先挂起，批量写完成后再发出，
+// 两边的帧不会在字节层面交错。读操作原样转发给 socket。
+class GatedSocket {
+public:
+    using socket_type = boost::asio::ip::tcp::socket;
+    using next_layer_type = socket_type;
+    using executor_type = socket_type::executor_type;
+
+    explicit GatedSocket(socket_type socket)
+        : m_socket(std::move(socket)), m_gate(m_socket.get_executor()) {
+        m_gate.expires_at(boost::asio::steady_timer::time_point::max());
+    }
+
+    executor_type get_executor() noexcept { return m_socket.get_executor(); }
+    socket_type& next_layer() noexcept { return m_socket; }
+    const socket_type& next_layer() const noexcept { return m_socket; }
+
+    // beast 有写操作在进行或挂起，此时不能直接写 socket
+    bool beastWriting() const noexcept { return m_beastWrites != 0; }
+
+    template <class MutableBufferSequence, class ReadHandler>
+    void async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler) {
+        m_socket.async_read_some(buffers, std::forward<ReadHandler>(handler));
+    }
+
+    // beast 的所有写都经过这里
+    template <class ConstBufferSequence, class WriteHandler>
+    void async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler) {
+        ++m_beastWrites;
+        Hook<std::decay_t<WriteHandler>> done(this, &GatedSocket::onBeastWrite,
+                                              std::forward<WriteHandler>(handler));
+        if (!m_gated) {
+            m_socket.async_write_some(buffers, std::move(done));
+            return;
+        }
+        m_gate.async_wait(
+            [this, buffers, done = std::move(done)](boost::system::error_code) mutable {
+                m_socket.async_write_some(buffers, std::move(done));
+            });
+    }
+
+    // 把 buffers 整体写出（asio::async_write 语义），完成前 beast 的写都挂起。
+    // 调用方保证 !beastWriting()，且同一时刻只有一个 gather 写
+    template <class ConstBufferSequence, class WriteHandler>
+    void asyncWriteGathered(const ConstBufferSequence& buffers, WriteHandler&& handler) {
+        m_gated = true;
+        boost::asio::async_write(m_socket, buffers,
+            Hook<std::decay_t<WriteHandler>>(this, &GatedSocket::openGate,
+                                             std::forward<WriteHandler>(handler)));
+    }
+
+private:
+    // 先回调 before 再调用原 handler，关联的 executor / allocator 原样转发
+    template <class Handler>
+    class Hook {
+    public:
+        using executor_type = boost::asio::associated_executor_t<Handler, GatedSocket::executor_type>;
+        using allocator_type = boost::asio::associated_allocator_t<Handler>;
+
+        Hook(GatedSocket* owner, void (GatedSocket::*before)(), Handler handler)
+            : m_owner(owner), m_before(before), m_handler(std::move(handler)) {}
+
+        executor_type get_executor() const noexcept {
+            return boost::asio::get_associated_executor(m_handler, m_owner->get_executor());
+        }
+        allocator_type get_allocator() const noexcept {
+            return boost::asio::get_associated_allocator(m_handler);
+        }
+
+        void operator()(boost::system::error_code ec, std::size_t bytes) {
+            (m_owner->*m_before)();
+            m_handler(ec, bytes);
+        }
+
+    private:
+        GatedSocket* m_owner;
+        void (GatedSocket::*m_before)();
+        Handler m_handler;
+    };
+
+    void onBeastWrite() { --m_beastWrites; }
+
+    void openGate() {
+        m_gated = false;
+        m_gate.cancel();    // 挂起的 beast 写以 operation_aborted 唤醒后真正发出
+    }
+
+private:
+    socket_type m_socket;
+    boost::asio::steady_timer m_gate;   // 永不到期，只用来挂起 beast 的写
+    size_t m_beastWrites = 0;
+    bool m_gated = false;
+};
+
+// beast 关闭 websocket 时按 ADL 查找下一层的 teardown，转给 tcp::socket 的实现
+inline void teardown(boost::beast::role_type role, GatedSocket& socket,
+                     boost::system::error_code& ec) {
+    boost::beast::websocket::teardown(role, socket.next_layer(), ec);
+}
+
+template <class TeardownHandler>
+void async_teardown(boost::beast::role_type role, GatedSocket& socket,
+                    TeardownHandler&& handler) {
+    boost::beast::websocket::async_teardown(role, socket.next_layer(),
+                                            std::forward<TeardownHandler>(handler));
+}
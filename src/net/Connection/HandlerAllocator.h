@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 为异步操作的 handler 提供可复用的内存。
+// 每个连接为读、写各持有一个 HandlerMemory；同一方向上同时最多只有一个异步操作，
+// 其 handler 以及 beast 组合操作的中间状态按栈的方式从这块内存中分配，
+// 全部释放后整块复位，稳态下读写不再走堆分配。放不下时退回 ::operator new。
+class HandlerMemory {
+public:
+    // beast 的 websocket 读/写、http 读的嵌套状态合计都在 1KB 以内
+    static constexpr size_t kCapacity = 1024;
+
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* allocate(size_t size) {
+        constexpr size_t align = alignof(std::max_align_t);
+        size_t aligned = (size + align - 1) & ~(align - 1);
+        if (m_used + aligned <= kCapacity) {
+            void* p = m_storage + m_used;
+            m_used += aligned;
+            ++m_live;
+            return p;
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void* p) {
+        auto* bytes = static_cast<unsigned char*>(p);
+        if (bytes >= m_storage && bytes < m_storage + kCapacity) {
+            if (--m_live == 0) m_used = 0;
+            return;
+        }
+        ::operator delete(p);
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_storage[kCapacity];
+    size_t m_used = 0;
+    size_t m_live = 0;
+};
+
+template <class T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& mem) : m_memory(&mem) {}
+
+    template <class U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : m_memory(other.m_memory) {}
+
+    T* allocate(size_t n) const {
+        return static_cast<T*>(m_memory->allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, size_t) const {
+        m_memory->deallocate(p);
+    }
+
+    bool operator==(const HandlerAllocator& other) const noexcept { return m_memory == other.m_memory; }
+    bool operator!=(const HandlerAllocator& other) const noexcept { return m_memory != other.m_memory; }
+
+private:
+    template <class> friend class HandlerAllocator;
+    HandlerMemory* m_memory;
+};
+
+// 包装 handler，通过 allocator_type 把 HandlerMemory 关联给 asio/beast
+template <class Handler>
+class AllocHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    AllocHandler(HandlerMemory& mem, Handler h) : m_memory(mem), m_handler(std::move(h)) {}
+
+    allocator_type get_allocator() const noexcept { return allocator_type(m_memory); }
+
+    template <class... Args>
+    void operator()(Args&&... args) {
+        m_handler(std::forward<Args>(args)...);
+    }
+
+private:
+    HandlerMemory& m_memory;
+    Handler m_handler;
+};
+
+template <class Handler>
+inline AllocHandler<std::decay_t<Handler>> makeAllocHandler(HandlerMemory& mem, Handler&& h) {
+    return AllocHandler<std::decay_t<Handler>>(mem, std::forward<Handler>(h));
+}
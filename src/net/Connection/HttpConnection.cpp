@@ -1,12 +1,70 @@
 #include "HttpConnection.h"
 #include "WebSocketConnection.h"
+#include "SessionManager.h"
 #include "Logger.h"
+#include "Thread_pool.h"
 #include <boost/beast/http.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
 
 namespace http = boost::beast::http;
 
-HttpConnection::HttpConnection(tcp::socket socket)
-    : m_socket(std::move(socket)) {
+namespace {
+HttpConnection::KeepAliveOptions g_keepAliveOptions;
+
+// 单次 sendfile 的字节数，以及一次回调里最多连续调用的次数；
+// 超过后让出 loop，等 socket 再次可写时继续
+constexpr size_t kSendfileChunk = 256 * 1024;
+constexpr int kSendfileChunksPerTurn = 16;
+
+// 每次预取的字节数，以及最多领先 sendfile 的字节数（正在发的一块 + 预取中的一块）
+constexpr uint64_t kPrefetchChunk = 1024 * 1024;
+constexpr uint64_t kPrefetchAhead = 2 * kPrefetchChunk;
+
+// 把 fd 的 [offset, offset + length) 读进 page cache，返回时 IO 已完成；会阻塞，只在 ThreadPool 上调用
+void makeResident(int fd, uint64_t offset, uint64_t length) {
+    // readahead 只负责把整段读一次性提交下去，不等 IO 完成
+    ::readahead(fd, static_cast<off64_t>(offset), static_cast<size_t>(length));
+
+    const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t begin = offset / page * page;
+    const size_t span = static_cast<size_t>(offset + length - begin);
+    void* map = ::mmap(nullptr, span, PROT_READ, MAP_SHARED, fd, static_cast<off_t>(begin));
+    if (map == MAP_FAILED) {
+        return;
+    }
+    // 只对还没读进来的页各 pread 一个字节，等它们的 IO 完成；已缓存的页不产生拷贝
+    std::vector<unsigned char> resident((span + page - 1) / page);
+    if (::mincore(map, span, resident.data()) == 0) {
+        char byte;
+        for (size_t i = 0; i < resident.size(); ++i) {
+            if (!(resident[i] & 1)) {
+                (void)::pread(fd, &byte, 1, static_cast<off_t>(begin + i * page));
+            }
+        }
+    }
+    ::munmap(map, span);
+}
+}
+
+void HttpConnection::setKeepAliveOptions(const KeepAliveOptions& options) {
+    g_keepAliveOptions = options;
+    LOG_INFO("Keep-alive options: idle_timeout={}ms, max_requests={}",
+             options.idleTimeoutMs, options.maxRequests);
+}
+
+HttpConnection::HttpConnection(tcp::socket socket, std::shared_ptr<EventLoop> loop,
+                               std::shared_ptr<ServerContext> context)
+    : Connection(std::move(loop)),
+      m_context(std::move(context)),
+      m_socket(std::move(socket)),
+      m_buffer(PoolAllocator<char>(m_loop->memoryPool())) {
     LOG_INFO("Created, this={}, remote={}",
              static_cast<void*>(this),
              remoteAddr());
@@ -15,58 +73,152 @@ HttpConnection::HttpConnection(tcp::socket socket)
 HttpConnection::~HttpConnection() {
     LOG_INFO("Destroyed, this={}",
              static_cast<void*>(this));
+#ifdef NET_USE_COROUTINES
+    // 挂起中的 serve() 不持有连接，连接没了就由这里释放协程帧
+    if (m_parked) {
+        std::exchange(m_parked, {}).destroy();
+    }
+#endif
 }
 
 void HttpConnection::start() {
     LOG_DEBUG("start, this={}", static_cast<void*>(this));
+#ifdef NET_USE_COROUTINES
+    serve();
+#else
     doRead();
+#endif
 }
 
+#ifdef NET_USE_COROUTINES
+DetachedTask HttpConnection::serve() {
+    for (;;) {
+        // 读的过程中只有协程帧持有连接
+        auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+
+        // 上一个请求已处理完；流水线请求的剩余字节仍在 m_buffer 中，会被直接解析
+        m_request = {};
+        armIdleTimer();
+
+        auto [ec, bytes] = co_await asyncIo([this](auto handler) {
+            http::async_read(m_socket, m_buffer, m_request,
+                             makeAllocHandler(m_readMemory, std::move(handler)));
+        });
+        if (!onRead(ec, bytes)) {
+            co_return;
+        }
+
+        // 🔑 应答可能由异步 handler 在别的线程给出；挂起期间由应答路径持有连接，
+        // keep-alive 时 onWrite 恢复这里，否则连接析构时销毁协程帧。
+        // 没有任何应答路径持有连接（handler 丢弃了 responder）时，放掉 self 就析构连接并销毁本帧
+        co_await parkAndRelease(m_parked, std::move(self));
+    }
+}
+#else
 void HttpConnection::doRead() {
     LOG_DEBUG("doRead, this={}", static_cast<void*>(this));
 
+    // 上一个请求已处理完；流水线请求的剩余字节仍在 m_buffer 中，会被直接解析
+    m_request = {};
+    armIdleTimer();
+
     auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
     http::async_read(
         m_socket,
         m_buffer,
         m_request,
-        [self](boost::system::error_code ec, std::size_t bytes) {
-            self->onRead(ec, bytes);
-        });
+        makeAllocHandler(m_readMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                self->onRead(ec, bytes);
+            }));
 }
+#endif
 
-void HttpConnection::onRead(boost::system::error_code ec, std::size_t bytes) {
+bool HttpConnection::onRead(boost::system::error_code ec, std::size_t bytes) {
+    // 含升级分支在内的整个处理耗时都记到本连接所在 loop（升级时 m_loop 是拷贝给 WebSocketConnection 的）
+    LoopStatsScope scope(m_loop->stats(), LoopStats::Kind::HttpRead);
     LOG_DEBUG("onRead, this={}, bytes={}",
               static_cast<void*>(this), bytes);
 
+    if (ec == http::error::end_of_stream) {
+        LOG_DEBUG("peer closed, this={}", static_cast<void*>(this));
+        close();
+        return false;
+    }
+
     if (ec) {
         LOG_WARN("read error, this={}, ec={}",
                  static_cast<void*>(this), ec.message());
         close();
-        return;
+        return false;
     }
 
     // ---- WebSocket Upgrade ----
     if (boost::beast::websocket::is_upgrade(m_request)) {
+        cancelIdleTimer();
         LOG_INFO("WebSocket upgrade, this={}",
                  static_cast<void*>(this));
 
-        auto ws = std::make_shared<WebSocketConnection>(
+        // 🔑 连接对象从 loop 的内存池分配，读缓冲区（含已分配的容量）一并移交
+        auto ws = std::allocate_shared<WebSocketConnection>(
+            PoolAllocator<WebSocketConnection>(m_loop->memoryPool()),
             std::move(m_socket),
-            std::move(m_request)
+            std::move(m_request),
+            std::move(m_buffer),
+            m_loop,
+            m_context
         );
 
-        // 🔑 继承 Session
-        if (auto s = getSession()) {
+        // 🔑 带有效恢复令牌的重连直接接回原 Session（保留登录状态等缓存），否则新建
+        if (auto s = resolveSession()) {
             ws->bindSession(s);
-            LOG_DEBUG("session moved to WS, sid={}", s->id());
+            LOG_DEBUG("session bound to WS, sid={}", s->id());
         }
+        // HTTP 连接对象到此为止，不能继续挂在 Session 上
+        detachSession();
 
         ws->start();
-        return;
+        return false;
     }
 
     handleRequest();
+    return true;
+}
+
+std::shared_ptr<Session> HttpConnection::resolveSession() {
+    if (auto s = getSession()) {
+        return s;
+    }
+    if (!m_context || !m_context->sessionManager) {
+        return nullptr;
+    }
+    auto& sessions = *m_context->sessionManager;
+
+    // 令牌优先从请求头取；浏览器的 WebSocket API 不能设置请求头，也接受 ?resume_token=
+    std::string_view token;
+    auto header = m_request.find(WebSocketConnection::kResumeTokenHeader);
+    if (header != m_request.end()) {
+        token = std::string_view(header->value().data(), header->value().size());
+    } else {
+        auto target = m_request.target();
+        std::string_view t(target.data(), target.size());
+        auto query = t.find('?');
+        if (query != std::string_view::npos) {
+            constexpr std::string_view kParam = "resume_token=";
+            auto pos = t.find(kParam, query);
+            if (pos != std::string_view::npos && (t[pos - 1] == '?' || t[pos - 1] == '&')) {
+                token = t.substr(pos + kParam.size());
+                token = token.substr(0, token.find('&'));
+            }
+        }
+    }
+
+    if (!token.empty()) {
+        if (auto s = sessions.resumeSession(token)) {
+            return s;
+        }
+    }
+    return sessions.createSession();
 }
 
 void HttpConnection::handleRequest() {
@@ -74,33 +226,277 @@ void HttpConnection::handleRequest() {
              static_cast<void*>(this),
              m_request.target());
 
-    // 🔑 response 必须活到 async_write 完成
-    auto res = std::make_shared<http::response<http::string_body>>();
-    res->version(m_request.version());
-    res->keep_alive(false);
-    res->result(http::status::ok);
-    res->set(http::field::server, "BeastServer");
-    res->body() = "Hello HTTP";
-    res->prepare_payload();
+    ++m_requestCount;
+    m_keepAlive = m_request.keep_alive() &&
+                  m_requestCount < g_keepAliveOptions.maxRequests;
+    m_awaitingReply = true;
+
+    HttpResponder responder(std::static_pointer_cast<HttpConnection>(shared_from_this()));
+    if (!m_context || !m_context->router) {
+        responder.send(http::status::not_found, "Not Found");
+        return;
+    }
+
+    auto target = m_request.target();
+    const HttpRouter::Handler* handler = nullptr;
+    RouteParams params;
+
+    switch (m_context->router->match(m_request.method(),
+                                     std::string_view(target.data(), target.size()),
+                                     handler, params)) {
+    case HttpRouter::Result::Matched:
+        try {
+            (*handler)(m_request, params, responder);
+        } catch (const std::exception& e) {
+            LOG_ERROR("handler error, this={}, what={}", static_cast<void*>(this), e.what());
+            if (m_awaitingReply) {
+                responder.send(http::status::internal_server_error, "Internal Server Error");
+            }
+        }
+        break;
+    case HttpRouter::Result::MethodNotAllowed:
+        responder.send(http::status::method_not_allowed, "Method Not Allowed");
+        break;
+    case HttpRouter::Result::NotFound:
+        responder.send(http::status::not_found, "Not Found");
+        break;
+    }
+}
+
+void HttpConnection::reply(HttpResponse res) {
+    // 同步处理时已在 loop 线程，直接写；异步处理（ThreadPool/DB）时投递回 loop
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+    boost::asio::dispatch(m_socket.get_executor(),
+        [self, res = std::move(res)]() mutable {
+            self->writeResponse(std::move(res));
+        });
+}
 
-    auto self = shared_from_this();
+void HttpConnection::writeResponse(HttpResponse res) {
+    if (!m_awaitingReply || m_closed) {
+        LOG_WARN("reply dropped, this={}, awaiting={}, closed={}",
+                 static_cast<void*>(this), m_awaitingReply, m_closed.load());
+        return;
+    }
+    m_awaitingReply = false;
+
+    m_response = std::move(res);
+    m_response.version(m_request.version());
+    m_response.keep_alive(m_keepAlive);
+    m_response.set(http::field::server, "BeastServer");
+    m_response.prepare_payload();
+
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
     http::async_write(
         m_socket,
-        *res,
-        [self, res](boost::system::error_code ec, std::size_t bytes) {
-            LOG_DEBUG("write done, this={}, bytes={}",
-                      static_cast<void*>(self.get()), bytes);
+        m_response,
+        makeAllocHandler(m_writeMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                self->onWrite(ec, bytes, self->m_keepAlive);
+            }));
+}
 
-            if (ec) {
-                LOG_WARN("write error, ec={}", ec.message());
-            }
+void HttpConnection::replyFile(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                               uint64_t offset, uint64_t length) {
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+    boost::asio::dispatch(m_socket.get_executor(),
+        [self, header = std::move(header), file = std::move(file), offset, length]() mutable {
+            self->writeFileResponse(std::move(header), std::move(file), offset, length);
+        });
+}
 
-            self->close();
+void HttpConnection::writeFileResponse(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                                       uint64_t offset, uint64_t length) {
+    if (!m_awaitingReply || m_closed) {
+        LOG_WARN("file reply dropped, this={}", static_cast<void*>(this));
+        return;
+    }
+    m_awaitingReply = false;
+
+    m_fileHeader = std::move(header);
+    m_fileHeader.version(m_request.version());
+    m_fileHeader.keep_alive(m_keepAlive);
+    m_fileHeader.set(http::field::server, "BeastServer");
+    m_fileHeader.content_length(length);
+
+    m_file = std::move(file);
+    m_fileOffset = static_cast<off_t>(offset);
+    m_fileRemaining = length;
+    m_fileResident = offset;
+    ++m_fileGeneration;
+    m_filePrefetching = false;
+    m_fileWaitingPrefetch = false;
+
+    // 写头部的同时开始预取第一块
+    prefetchFile();
+
+    // 先写头部（empty_body 不会输出 body），body 交给 sendfile 零拷贝发送
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+    http::async_write(
+        m_socket,
+        m_fileHeader,
+        makeAllocHandler(m_writeMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                if (ec || !self->m_file) {
+                    self->m_file.reset();
+                    self->onWrite(ec, bytes, self->m_keepAlive);
+                    return;
+                }
+                self->doSendFile();
+            }));
+}
+
+void HttpConnection::doSendFile() {
+    boost::system::error_code ec;
+    m_socket.native_non_blocking(true, ec);
+
+    for (int i = 0; i < kSendfileChunksPerTurn && m_fileRemaining > 0; ++i) {
+        // 🔑 不越过预取边界：边界之后的数据可能还在磁盘上，sendfile 会阻塞 loop
+        uint64_t resident = m_fileResident - static_cast<uint64_t>(m_fileOffset);
+        if (resident == 0) {
+            break;
+        }
+        size_t chunk = static_cast<size_t>(std::min({m_fileRemaining, resident,
+                                                     static_cast<uint64_t>(kSendfileChunk)}));
+        ssize_t n = ::sendfile(m_socket.native_handle(), m_file->fd(), &m_fileOffset, chunk);
+
+        if (n > 0) {
+            m_fileRemaining -= static_cast<uint64_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+
+        // n == 0：文件在发送过程中被截断；其余为真正的错误
+        LOG_WARN("sendfile failed, this={}, remaining={}, err={}",
+                 static_cast<void*>(this), m_fileRemaining, n == 0 ? "eof" : std::strerror(errno));
+        m_file.reset();
+        close();
+        return;
+    }
+
+    if (m_fileRemaining == 0) {
+        m_file.reset();
+        onWrite({}, 0, m_keepAlive);
+        return;
+    }
+
+    prefetchFile();
+    if (m_fileResident == static_cast<uint64_t>(m_fileOffset)) {
+        // 已发到预取边界，由 onFilePrefetched 继续
+        m_fileWaitingPrefetch = true;
+        return;
+    }
+
+    // socket 发送缓冲区已满（或本轮配额用完），等可写后继续
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+    m_socket.async_wait(tcp::socket::wait_write,
+        makeAllocHandler(m_writeMemory,
+            [self](boost::system::error_code ec) {
+                if (ec) {
+                    self->m_file.reset();
+                    self->onWrite(ec, 0, self->m_keepAlive);
+                    return;
+                }
+                self->doSendFile();
+            }));
+}
+
+void HttpConnection::prefetchFile() {
+    uint64_t end = static_cast<uint64_t>(m_fileOffset) + m_fileRemaining;
+    if (m_filePrefetching || !m_file || m_fileResident >= end ||
+        m_fileResident - static_cast<uint64_t>(m_fileOffset) >= kPrefetchAhead) {
+        return;
+    }
+
+    uint64_t from = m_fileResident;
+    uint64_t length = std::min(end - from, kPrefetchChunk);
+    m_filePrefetching = true;
+
+    auto self = std::static_pointer_cast<HttpConnection>(shared_from_this());
+    ThreadPool::detach_task([self, file = m_file, generation = m_fileGeneration, from, length] {
+        makeResident(file->fd(), from, length);
+        boost::asio::post(self->m_socket.get_executor(), [self, generation, residentEnd = from + length] {
+            self->onFilePrefetched(generation, residentEnd);
         });
+    });
 }
 
+void HttpConnection::onFilePrefetched(uint64_t generation, uint64_t residentEnd) {
+    if (generation != m_fileGeneration || !m_file) {
+        return;     // 应答已结束（出错或连接关闭），或已是下一个文件应答
+    }
+    m_filePrefetching = false;
+    m_fileResident = residentEnd;
+    prefetchFile();     // 发这一块的同时预取下一块
 
-void HttpConnection::send(const std::string&) {
+    if (m_fileWaitingPrefetch) {
+        m_fileWaitingPrefetch = false;
+        doSendFile();
+    }
+}
+
+void HttpConnection::onWrite(boost::system::error_code ec, std::size_t bytes, bool keepAlive) {
+    LoopStatsScope scope(m_loop->stats(), LoopStats::Kind::Write);
+    LOG_DEBUG("write done, this={}, bytes={}",
+              static_cast<void*>(this), bytes);
+
+    if (ec) {
+        LOG_WARN("write error, ec={}", ec.message());
+        close();
+        return;
+    }
+
+    if (!keepAlive) {
+        close();
+        return;
+    }
+
+    // 🔑 keep-alive：回到同一个 socket 上读下一个请求（流水线请求按顺序逐个应答）
+#ifdef NET_USE_COROUTINES
+    if (m_parked) {
+        std::exchange(m_parked, {}).resume();
+    }
+#else
+    doRead();
+#endif
+}
+
+void HttpConnection::armIdleTimer() {
+    // 已有定时器时只在时间轮上挪位置，不重新创建回调
+    if (m_idleTimer && m_loop->resetTimer(m_idleTimer, g_keepAliveOptions.idleTimeoutMs)) {
+        return;
+    }
+
+    std::weak_ptr<HttpConnection> weak =
+        std::static_pointer_cast<HttpConnection>(shared_from_this());
+    m_idleTimer = m_loop->runAfter(g_keepAliveOptions.idleTimeoutMs, [weak] {
+        if (auto self = weak.lock()) {
+            self->m_idleTimer = {};
+            // 请求还在处理（异步 handler / sendfile）时不算空闲，重新计时
+            if (self->m_awaitingReply || self->m_file) {
+                self->armIdleTimer();
+                return;
+            }
+            LOG_DEBUG("idle timeout, this={}", static_cast<void*>(self.get()));
+            self->close();
+        }
+    });
+}
+
+void HttpConnection::cancelIdleTimer() {
+    if (m_idleTimer) {
+        m_loop->cancelTimer(m_idleTimer);
+        m_idleTimer = {};
+    }
+}
+
+
+void HttpConnection::send(MessageBuffer::Ptr) {
     LOG_WARN("send() ignored (HTTP), this={}",
              static_cast<void*>(this));
 }
@@ -114,9 +510,11 @@ void HttpConnection::close() {
     LOG_INFO("close, this={}", static_cast<void*>(this));
 
     // 🔑 通知 Session（此时 shared_ptr 仍然安全）
-    if (auto s = getSession()) {
-        s->detach(shared_from_this());
-        LOG_DEBUG("detached from session, sid={}", s->id());
+    detachSession();
+
+    // 时间轮只能在 loop 线程操作；其它线程关闭时由回调中的 weak_ptr 兜底
+    if (m_loop->isInLoopThread()) {
+        cancelIdleTimer();
     }
 
     boost::system::error_code ec;
@@ -1,32 +1,93 @@
 #pragma once
 #include "Connection.h"
+#include "ServerContext.h"
+#include "HttpRouter.h"
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/core.hpp>
 #include <atomic>
+#ifdef NET_USE_COROUTINES
+#include "Awaitables.h"
+#endif
 
 class HttpConnection
-    : public Connection {
+    : public Connection,
+      public HttpReplySink {
 public:
     using tcp = boost::asio::ip::tcp;
 
-    explicit HttpConnection(tcp::socket socket);
+    // ---- keep-alive 配置（启动时由 NetBootstrap 设置，之后只读）----
+    struct KeepAliveOptions {
+        size_t idleTimeoutMs = 5000;    // 两个请求之间最长空闲时间
+        size_t maxRequests = 100;       // 单个连接最多处理的请求数
+    };
+    static void setKeepAliveOptions(const KeepAliveOptions& options);
+
+    HttpConnection(tcp::socket socket, std::shared_ptr<EventLoop> loop,
+                   std::shared_ptr<ServerContext> context);
     ~HttpConnection();
 
     void start() override;
-    void send(const std::string& data) override;
+    using Connection::send;
+    void send(MessageBuffer::Ptr msg) override;
     void close() override;
     std::string remoteAddr() const override;
 
+    // HttpReplySink：路由处理函数通过 HttpResponder 回到这里，可在任意线程调用
+    void reply(HttpResponse res) override;
+    void replyFile(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                   uint64_t offset, uint64_t length) override;
+
 private:
+#ifdef NET_USE_COROUTINES
+    // 读请求 → 分发 → 等应答写完 → 下一个请求，一个协程走完整个 keep-alive 循环
+    DetachedTask serve();
+#else
     void doRead();
-    void onRead(boost::system::error_code ec, std::size_t bytes);
+#endif
+    // 返回 false 表示连接已关闭或已移交给 WebSocket，不再读下一个请求
+    bool onRead(boost::system::error_code ec, std::size_t bytes);
+    std::shared_ptr<Session> resolveSession();
     void handleRequest();
+    void writeResponse(HttpResponse res);
+    void writeFileResponse(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                           uint64_t offset, uint64_t length);
+    void doSendFile();
+    void prefetchFile();
+    void onFilePrefetched(uint64_t generation, uint64_t residentEnd);
+    void onWrite(boost::system::error_code ec, std::size_t bytes, bool keepAlive);
+    void armIdleTimer();
+    void cancelIdleTimer();
 
 private:
+    std::shared_ptr<ServerContext> m_context;
     tcp::socket m_socket;
-    boost::beast::flat_buffer m_buffer;
+    Buffer m_buffer;
+    HandlerMemory m_readMemory;     // 读 handler 的复用内存
+    HandlerMemory m_writeMemory;    // 写 handler 的复用内存
     boost::beast::http::request<boost::beast::http::string_body> m_request;
+    // 🔑 同一连接上的请求串行处理，response 作为成员活到 async_write 完成
+    boost::beast::http::response<boost::beast::http::string_body> m_response;
+    EventLoop::TimerId m_idleTimer;     // loop 时间轮上的空闲超时
+    size_t m_requestCount = 0;
+    bool m_keepAlive = false;       // 当前请求应答后是否保持连接
+    bool m_awaitingReply = false;   // 当前请求尚未应答
+
+    // ---- sendfile 状态 ----
+    // 🔑 磁盘读全部在 ThreadPool 上按块预取，sendfile 只发已在 page cache 中的部分
+    HttpFileHeader m_fileHeader;
+    std::shared_ptr<const FileHandle> m_file;
+    off_t m_fileOffset = 0;
+    uint64_t m_fileRemaining = 0;
+    uint64_t m_fileResident = 0;        // [m_fileOffset, m_fileResident) 已预取
+    uint64_t m_fileGeneration = 0;      // 每个文件应答 +1，丢弃上一个应答迟到的预取结果
+    bool m_filePrefetching = false;
+    bool m_fileWaitingPrefetch = false; // 已发到预取边界，等预取完成后继续
+
+#ifdef NET_USE_COROUTINES
+    // 等应答写完时挂起的 serve()；onWrite 恢复它，连接析构时销毁它
+    std::coroutine_handle<> m_parked;
+#endif
 
     // 🔑 关闭状态（必须有）
     std::atomic_bool m_closed{false};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <boost/asio/buffer.hpp>
+
+// 不可变、引用计数的出站消息。
+// 广播时只序列化一次，所有接收方的发送队列共享同一份 payload，不再逐个拷贝。
+class MessageBuffer {
+    struct PrivateTag {};
+
+public:
+    using Ptr = std::shared_ptr<const MessageBuffer>;
+
+    enum class Type {
+        Text,
+        Binary
+    };
+
+    static Ptr make(std::string payload, Type type = Type::Text) {
+        return std::make_shared<const MessageBuffer>(PrivateTag{}, std::move(payload), type);
+    }
+
+    MessageBuffer(PrivateTag, std::string payload, Type type)
+        : m_payload(std::move(payload)), m_type(type) {}
+
+    MessageBuffer(const MessageBuffer&) = delete;
+    MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+    std::string_view payload() const { return m_payload; }
+    size_t size() const { return m_payload.size(); }
+    bool isText() const { return m_type == Type::Text; }
+    Type type() const { return m_type; }
+
+    // 供 async_write 直接引用，调用方需持有 Ptr 直到写完成
+    boost::asio::const_buffer buffer() const {
+        return boost::asio::buffer(m_payload.data(), m_payload.size());
+    }
+
+private:
+    const std::string m_payload;
+    const Type m_type;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <memory>
+
+class SessionManager;
+class HttpRouter;
+class WsMessageHandler;
+class RoomManager;
+class OfflineLog;
+class WriteBehind;
+class SessionToken;
+
+// 服务器级共享对象，由 NetBootstrap 创建，经 Acceptor 传给每个连接
+struct ServerContext {
+    std::shared_ptr<SessionManager> sessionManager;
+    std::shared_ptr<HttpRouter> router;
+    std::shared_ptr<WsMessageHandler> wsHandler;
+    std::shared_ptr<RoomManager> rooms;
+    std::shared_ptr<OfflineLog> offlineLog;     // 未启用时为空
+    std::shared_ptr<WriteBehind> messageWriter; // 聊天消息写后持久化，未启用时为空
+    std::shared_ptr<const SessionToken> loginTickets;   // 登录票据校验，未配置 login_secret 时为空
+};
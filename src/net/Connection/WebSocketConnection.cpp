@@ -1,84 +1,654 @@
 #include "WebSocketConnection.h"
+#include "SessionManager.h"
+#include "OfflineLog.h"
 #include "Logger.h"
+#include <algorithm>
+#include <utility>
 
 namespace websocket = boost::beast::websocket;
 using tcp = boost::asio::ip::tcp;
 
+namespace {
+WebSocketConnection::OutboundLimits g_outboundLimits;
+WebSocketConnection::HeartbeatOptions g_heartbeatOptions;
+
+// 按 opcode 预先建好的分发表，下标为 got_text()
+using DispatchFn = void (*)(WsMessageHandler&, WebSocketConnection&, const char*, size_t);
+
+void dispatchBinary(WsMessageHandler& h, WebSocketConnection& c, const char* data, size_t size) {
+    h.onBinary(c, boost::asio::const_buffer(data, size));
+}
+
+void dispatchText(WsMessageHandler& h, WebSocketConnection& c, const char* data, size_t size) {
+    h.onText(c, std::string_view(data, size));
+}
+
+constexpr DispatchFn kDispatch[2] = {dispatchBinary, dispatchText};
+
+// 服务端数据帧的帧头（RFC 6455 5.2）：FIN=1、不加掩码、整条消息一帧，返回帧头长度
+size_t encodeFrameHeader(unsigned char* out, bool text, uint64_t size) {
+    out[0] = 0x80 | (text ? 0x1 : 0x2);
+    if (size < 126) {
+        out[1] = static_cast<unsigned char>(size);
+        return 2;
+    }
+    if (size <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = static_cast<unsigned char>(size >> 8);
+        out[3] = static_cast<unsigned char>(size);
+        return 4;
+    }
+    out[1] = 127;
+    for (int i = 0; i < 8; ++i) {
+        out[2 + i] = static_cast<unsigned char>(size >> (56 - 8 * i));
+    }
+    return 10;
+}
+
+std::atomic<uint64_t> g_droppedOldest{0};
+std::atomic<uint64_t> g_droppedNewest{0};
+std::atomic<uint64_t> g_disconnects{0};
+}
+
+WebSocketConnection::OutboundLimits::Policy
+WebSocketConnection::OutboundLimits::parsePolicy(const std::string& name) {
+    if (name == "drop_newest") return Policy::DropNewest;
+    if (name == "disconnect") return Policy::Disconnect;
+    if (name != "drop_oldest") {
+        LOG_WARN("Unknown overflow policy '{}', fallback to drop_oldest", name);
+    }
+    return Policy::DropOldest;
+}
+
+void WebSocketConnection::setOutboundLimits(const OutboundLimits& limits) {
+    g_outboundLimits = limits;
+    LOG_INFO("Outbound limits: high={}B/{}msgs, low={}B/{}msgs, policy={}",
+             limits.highWatermarkBytes, limits.highWatermarkMessages,
+             limits.lowWatermarkBytes, limits.lowWatermarkMessages,
+             static_cast<int>(limits.policy));
+}
+
+const WebSocketConnection::OutboundLimits& WebSocketConnection::outboundLimits() {
+    return g_outboundLimits;
+}
+
+WebSocketConnection::BackpressureStats WebSocketConnection::backpressureStats() {
+    BackpressureStats stats;
+    stats.droppedOldest = g_droppedOldest.load(std::memory_order_relaxed);
+    stats.droppedNewest = g_droppedNewest.load(std::memory_order_relaxed);
+    stats.disconnects = g_disconnects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void WebSocketConnection::setHeartbeatOptions(const HeartbeatOptions& options) {
+    g_heartbeatOptions = options;
+    LOG_INFO("WebSocket heartbeat: handshake={}ms, ping={}ms, pong={}ms, close={}ms",
+             options.handshakeTimeoutMs, options.pingIntervalMs,
+             options.pongTimeoutMs, options.closeTimeoutMs);
+}
+
 WebSocketConnection::WebSocketConnection(
     tcp::socket socket,
-    boost::beast::http::request<boost::beast::http::string_body> req)
-    : m_ws(std::move(socket)), m_request(std::move(req)) {
+    boost::beast::http::request<boost::beast::http::string_body> req,
+    Buffer buffer,
+    std::shared_ptr<EventLoop> loop,
+    std::shared_ptr<ServerContext> context)
+    : Connection(std::move(loop)),
+      m_context(std::move(context)),
+      m_handler(m_context ? m_context->wsHandler.get() : nullptr),
+      m_ws(std::move(socket)), m_buffer(std::move(buffer)), m_request(std::move(req)) {
+    // 启用 permessage-deflate 后帧要由 beast 压缩，只能逐条交给 async_write
+    websocket::permessage_deflate pmd;
+    m_ws.get_option(pmd);
+    m_gatherWrites = !pmd.server_enable;
+    m_gather.reserve(kMaxGatherMessages * 2);
 
     LOG_INFO("Created, this={}",
              static_cast<void*>(this));
 }
 
 void WebSocketConnection::start() {
-    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
-
-    m_ws.set_option(websocket::stream_base::timeout::suggested(
-        boost::beast::role_type::server));
+    // 🔑 超时全部交给 loop 的时间轮：beast 自带的超时每个连接一个 steady_timer，
+    // 每次读写都要重新 expires_after，连接数大时开销明显
+    websocket::stream_base::timeout opt{};
+    opt.handshake_timeout = websocket::stream_base::none();
+    opt.idle_timeout = websocket::stream_base::none();
+    opt.keep_alive_pings = false;
+    m_ws.set_option(opt);
+    if (auto session = getSession(); session && m_context && m_context->sessionManager) {
+        m_resumeToken = m_context->sessionManager->issueResumeToken(session);
+    }
     m_ws.set_option(websocket::stream_base::decorator(
-        [](websocket::response_type& res) {
+        [token = m_resumeToken](websocket::response_type& res) {
             res.set(boost::beast::http::field::server, "Beast-WebSocket");
+            if (!token.empty()) {
+                res.set(kResumeTokenHeader, token);
+            }
         }));
 
+    // 读到 ping / pong 同样说明对端还活着
+    m_ws.control_callback(
+        [this](websocket::frame_type, boost::beast::string_view) { onActivity(); });
+
+    armTimer(g_heartbeatOptions.handshakeTimeoutMs);
+
+#ifdef NET_USE_COROUTINES
+    run();
+#else
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
     m_ws.async_accept(
         m_request,
         [self](boost::system::error_code ec) {
-            if (ec) {
-                self->fail(ec, "accept");
-                return;
+            if (self->onAccept(ec)) {
+                self->doRead();
             }
-            LOG_INFO("handshake success");
-            self->doRead();
         });
+#endif
+}
+
+bool WebSocketConnection::onAccept(boost::system::error_code ec) {
+    if (ec) {
+        cancelTimer();
+        fail(ec, "accept");
+        detachSession();
+        return false;
+    }
+    LOG_INFO("handshake success");
+    m_handshakeDone = true;
+    armTimer(g_heartbeatOptions.pingIntervalMs);
+    if (m_handler) m_handler->onOpen(*this);
+    deliverOffline();
+    doWrite();    // 握手期间排队的消息
+    return true;
 }
 
+#ifdef NET_USE_COROUTINES
+DetachedTask WebSocketConnection::run() {
+    // 协程帧持有连接直到读循环结束（出错或被 forceClose）
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+
+    IoResult accepted = co_await asyncIo([this](auto handler) {
+        m_ws.async_accept(m_request, std::move(handler));
+    });
+    if (!onAccept(accepted.ec)) {
+        co_return;
+    }
+
+    for (;;) {
+        auto [ec, bytes] = co_await asyncIo([this](auto handler) {
+            m_ws.async_read(m_buffer, makeAllocHandler(m_readMemory, std::move(handler)));
+        });
+        if (!onRead(ec, bytes)) {
+            co_return;
+        }
+    }
+}
+#else
 void WebSocketConnection::doRead() {
     auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
     m_ws.async_read(
         m_buffer,
-        [self](boost::system::error_code ec, std::size_t bytes) {
-            self->onRead(ec, bytes);
-        });
+        makeAllocHandler(m_readMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                if (self->onRead(ec, bytes)) {
+                    self->doRead();
+                }
+            }));
 }
+#endif
 
-void WebSocketConnection::onRead(boost::system::error_code ec,
+bool WebSocketConnection::onRead(boost::system::error_code ec,
                                  std::size_t bytes) {
+    LoopStatsScope scope(m_loop->stats(), LoopStats::Kind::WsRead);
     if (ec) {
+        cancelTimer();
         fail(ec, "read");
+        if (m_handler) m_handler->onClose(*this);
+        // 读循环结束即连接结束；Session 进入重连宽限期
+        detachSession();
+        return false;
+    }
+
+    onActivity();
+
+    LOG_DEBUG("recv, this={}, bytes={}, text={}",
+              static_cast<void*>(this), bytes, m_ws.got_text());
+
+    dispatchMessage();
+
+    m_buffer.consume(m_buffer.size());
+    return true;
+}
+
+void WebSocketConnection::dispatchMessage() {
+    if (!m_handler) return;
+
+    // 🔑 flat_buffer 中的帧是连续内存，直接以视图交给业务层，不拷贝
+    auto data = m_buffer.cdata();
+    try {
+        kDispatch[m_ws.got_text()](*m_handler, *this,
+                                   static_cast<const char*>(data.data()), data.size());
+    } catch (const std::exception& e) {
+        LOG_ERROR("message handler error, this={}, what={}",
+                  static_cast<void*>(this), e.what());
+    }
+}
+
+void WebSocketConnection::send(MessageBuffer::Ptr msg) {
+    if (!msg) return;
+
+    // 🔑 队列持有 MessageBuffer 的引用，广播时各连接共享同一份 payload
+    if (m_loop->isInLoopThread()) {
+        enqueue(std::move(msg));
+        return;
+    }
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::post(m_ws.get_executor(),
+        [self, msg = std::move(msg)]() mutable {
+            self->enqueue(std::move(msg));
+        });
+}
+
+void WebSocketConnection::sendBatch(std::vector<MessageBuffer::Ptr> msgs) {
+    if (msgs.empty()) return;
+
+    if (m_loop->isInLoopThread()) {
+        for (auto& msg : msgs) {
+            if (msg) enqueue(std::move(msg));
+        }
+        return;
+    }
+
+    // 整批一次 post，而不是每条消息一次
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::post(m_ws.get_executor(),
+        [self, msgs = std::move(msgs)]() mutable {
+            for (auto& msg : msgs) {
+                if (msg) self->enqueue(std::move(msg));
+            }
+        });
+}
+
+size_t WebSocketConnection::deliverOffline() {
+    OfflineLog* log = m_context ? m_context->offlineLog.get() : nullptr;
+    auto session = getSession();
+    const auto slot = PresenceIndex::userIdSlot();
+    if (!log || !session || !session->has(slot) || m_closing) {
+        return 0;
+    }
+    // 上一批还没写完：写完确认后会接着取下一批
+    if (!m_offlineInflight.empty()) {
+        return 0;
+    }
+
+    // 🔑 一批只用到发送队列高水位之前的余量（条数和字节都算），这批消息不会被背压策略丢掉；
+    //    没有余量时等队列排空再取
+    size_t depth = m_outbox.size();
+    size_t bytes = m_queuedBytes.load(std::memory_order_relaxed);
+    if (m_congested || depth >= g_outboundLimits.highWatermarkMessages ||
+        bytes >= g_outboundLimits.highWatermarkBytes) {
+        m_offlineDeferred = true;
+        return 0;
+    }
+    m_offlineDeferred = false;
+
+    uint64_t userId = session->get(slot);
+    auto messages = log->peek(userId, g_outboundLimits.highWatermarkMessages - depth,
+                              g_outboundLimits.highWatermarkBytes - bytes);
+    if (messages.empty()) {
+        return 0;
+    }
+
+    m_offlineUser = userId;
+    m_offlineWrittenSeq = 0;
+    for (auto& m : messages) {
+        auto msg = MessageBuffer::make(std::move(m.payload));
+        m_offlineInflight.emplace_back(msg.get(), m.seq);
+        enqueue(std::move(msg));
+    }
+
+    LOG_INFO("offline messages delivered, uid={}, count={}, this={}",
+             userId, messages.size(), static_cast<void*>(this));
+    return messages.size();
+}
+
+void WebSocketConnection::ackOffline() {
+    // 只确认已经写出去的前缀；被丢弃或没来得及写的留在日志里，下次登录重发
+    if (m_offlineWrittenSeq != 0 && m_context && m_context->offlineLog) {
+        m_context->offlineLog->ack(m_offlineUser, m_offlineWrittenSeq);
+    }
+    m_offlineInflight.clear();
+    m_offlineWrittenSeq = 0;
+}
+
+const std::shared_ptr<ServerContext>& WebSocketConnection::context() const {
+    return m_context;
+}
+
+void WebSocketConnection::enqueue(MessageBuffer::Ptr msg) {
+    if (m_closing) {
         return;
     }
 
-    std::string msg = boost::beast::buffers_to_string(
-        m_buffer.data());
+    size_t depth = m_outbox.size();
+    size_t bytes = m_queuedBytes.load(std::memory_order_relaxed);
+    if (!m_congested && overWatermark(depth + 1, bytes + msg->size(), true)) {
+        m_congested = true;
+        LOG_WARN("outbound queue over high watermark, this={}, depth={}, bytes={}",
+                 static_cast<void*>(this), depth, bytes);
+    }
 
-    LOG_INFO("recv: {}", msg);
+    if (m_congested) {
+        switch (g_outboundLimits.policy) {
+        case OutboundLimits::Policy::DropNewest:
+            g_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+            return;
+        case OutboundLimits::Policy::Disconnect:
+            g_disconnects.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN("slow consumer disconnected, this={}, depth={}, bytes={}",
+                     static_cast<void*>(this), depth, bytes);
+            forceClose();
+            return;
+        case OutboundLimits::Policy::DropOldest:
+            dropOldest(msg->size());
+            break;
+        }
+    }
 
-    m_ws.text(true);
-    send("Echo: " + msg);
+    m_queuedBytes.fetch_add(msg->size(), std::memory_order_relaxed);
+    m_queueDepth.fetch_add(1, std::memory_order_relaxed);
+    m_outbox.push_back(std::move(msg));
 
-    m_buffer.consume(bytes);
-    doRead();
+    // 已有写操作在进行时只入队，由 onWrite 继续排空
+    if (!m_writing) {
+        doWrite();
+    }
 }
 
-void WebSocketConnection::send(const std::string& msg) {
+void WebSocketConnection::doWrite() {
+    if (m_writing || !m_handshakeDone || m_outbox.empty()) {
+        return;
+    }
+
+    m_writing = true;
+
+    // 🔑 积压了多条时合并成一次 gather 写：N 条消息一次 sendmsg，而不是 N 次。
+    //    beast 自己的 ping/pong/close 正在写时不能插进去，这次先逐条写
+    if (m_gatherWrites && !m_closing && m_outbox.size() > 1 && !m_ws.next_layer().beastWriting()) {
+        writeGathered();
+        return;
+    }
+
+    const auto& msg = m_outbox.front();
+    m_writeCount = 1;
+    m_ws.text(msg->isText());
+
+    // 服务端帧不加掩码且未启用 permessage-deflate，beast 会把帧头和共享的 payload
+    // 一起 gather 写出，payload 不会被拷贝
     auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
     m_ws.async_write(
-        boost::asio::buffer(msg),
-        [self](boost::system::error_code ec, std::size_t) {
-            if (ec) self->fail(ec, "write");
-        });
+        msg->buffer(),
+        makeAllocHandler(m_writeMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                self->onWrite(ec, bytes);
+            }));
+}
+
+void WebSocketConnection::writeGathered() {
+    // 服务端帧不加掩码、未压缩，帧头自己编码，payload 直接引用共享的 MessageBuffer
+    m_gather.clear();
+    size_t count = 0;
+    size_t bytes = 0;
+    for (const auto& msg : m_outbox) {
+        if (count == kMaxGatherMessages || (count > 0 && bytes + msg->size() > kMaxGatherBytes)) {
+            break;
+        }
+        auto& header = m_frameHeaders[count];
+        size_t headerSize = encodeFrameHeader(header.data(), msg->isText(), msg->size());
+        m_gather.emplace_back(header.data(), headerSize);
+        m_gather.push_back(msg->buffer());
+        bytes += msg->size();
+        ++count;
+    }
+    m_writeCount = count;
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    m_ws.next_layer().asyncWriteGathered(
+        m_gather,
+        makeAllocHandler(m_writeMemory,
+            [self](boost::system::error_code ec, std::size_t bytes) {
+                self->onWrite(ec, bytes);
+            }));
+}
+
+void WebSocketConnection::onWrite(boost::system::error_code ec, std::size_t) {
+    LoopStatsScope scope(m_loop->stats(), LoopStats::Kind::Write);
+    m_writing = false;
+    size_t written = std::exchange(m_writeCount, 0);
+
+    if (ec) {
+        clearQueue();
+        fail(ec, "write");
+        return;
+    }
+
+    // 整批释放；离线消息记下已写出的序号，一批全部写完才确认
+    bool offlineDone = false;
+    for (size_t i = 0; i < written; ++i) {
+        if (!m_offlineInflight.empty() && m_offlineInflight.front().first == m_outbox.front().get()) {
+            m_offlineWrittenSeq = m_offlineInflight.front().second;
+            m_offlineInflight.pop_front();
+            offlineDone = m_offlineInflight.empty();
+        }
+        popFront();
+    }
+
+    if (m_congested &&
+        !overWatermark(m_outbox.size(), m_queuedBytes.load(std::memory_order_relaxed), false)) {
+        m_congested = false;
+        LOG_INFO("outbound queue below low watermark, this={}", static_cast<void*>(this));
+    }
+
+    if (offlineDone) {
+        ackOffline();
+        deliverOffline();   // 日志里还有的话接着发下一批
+    } else if (m_offlineDeferred && m_outbox.empty()) {
+        deliverOffline();
+    }
+
+    // 写期间积压的消息在这里连续排空，不再逐条 post
+    doWrite();
+}
+
+bool WebSocketConnection::overWatermark(size_t depth, size_t bytes, bool high) const {
+    if (high) {
+        return depth > g_outboundLimits.highWatermarkMessages ||
+               bytes > g_outboundLimits.highWatermarkBytes;
+    }
+    return depth > g_outboundLimits.lowWatermarkMessages ||
+           bytes > g_outboundLimits.lowWatermarkBytes;
+}
+
+void WebSocketConnection::dropOldest(size_t incomingBytes) {
+    // 队首正在写的消息不能丢弃
+    size_t keep = m_writeCount;
+    size_t dropped = 0;
+
+    while (m_outbox.size() > keep &&
+           overWatermark(m_outbox.size() + 1,
+                         m_queuedBytes.load(std::memory_order_relaxed) + incomingBytes,
+                         false)) {
+        auto it = m_outbox.begin() + keep;
+        // 丢掉的是本批离线消息中的一条：放弃这一批，只确认已写出的前缀
+        auto offline = std::find_if(m_offlineInflight.begin(), m_offlineInflight.end(),
+                                    [&](const auto& entry) { return entry.first == it->get(); });
+        if (offline != m_offlineInflight.end()) {
+            ackOffline();
+        }
+        m_queuedBytes.fetch_sub((*it)->size(), std::memory_order_relaxed);
+        m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        m_outbox.erase(it);
+        ++dropped;
+    }
+
+    g_droppedOldest.fetch_add(dropped, std::memory_order_relaxed);
+    m_congested = false;
+    LOG_DEBUG("dropped {} oldest messages, this={}", dropped, static_cast<void*>(this));
+}
+
+void WebSocketConnection::clearQueue() {
+    if (!m_offlineInflight.empty()) {
+        ackOffline();
+    }
+    // 正在写的队首消息要保留到 onWrite，其缓冲区仍被写操作引用
+    while (m_outbox.size() > m_writeCount) {
+        m_queuedBytes.fetch_sub(m_outbox.back()->size(), std::memory_order_relaxed);
+        m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        m_outbox.pop_back();
+    }
+}
+
+void WebSocketConnection::popFront() {
+    m_queuedBytes.fetch_sub(m_outbox.front()->size(), std::memory_order_relaxed);
+    m_queueDepth.fetch_sub(1, std::memory_order_relaxed);
+    m_outbox.pop_front();
+}
+
+size_t WebSocketConnection::queueDepth() const {
+    return m_queueDepth.load(std::memory_order_relaxed);
+}
+
+size_t WebSocketConnection::queuedBytes() const {
+    return m_queuedBytes.load(std::memory_order_relaxed);
 }
 
 void WebSocketConnection::close() {
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    boost::asio::dispatch(m_ws.get_executor(), [self] { self->doClose(); });
+}
+
+void WebSocketConnection::doClose() {
+    if (m_closing) {
+        return;
+    }
+    if (!m_handshakeDone) {
+        forceClose();
+        return;
+    }
+
+    m_closing = true;
+    armTimer(g_heartbeatOptions.closeTimeoutMs);
+
+    if (m_pingInFlight) {
+        m_closePending = true;
+        return;
+    }
+    sendClose();
+}
+
+void WebSocketConnection::sendClose() {
+    // 🔑 异步 close：同步 close 会阻塞 loop 直到对端回复 close 帧
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    m_ws.async_close(websocket::close_code::normal,
+        [self](boost::system::error_code ec) {
+            if (ec) self->fail(ec, "close");
+        });
+}
+
+void WebSocketConnection::forceClose() {
+    // 慢消费者连 close 帧也读不走，直接关闭底层 socket，挂起的读写会以错误返回
+    m_closing = true;
+    m_closePending = false;
+    cancelTimer();
+    clearQueue();
+
     boost::system::error_code ec;
-    m_ws.close(websocket::close_code::normal, ec);
+    boost::beast::get_lowest_layer(m_ws).shutdown(tcp::socket::shutdown_both, ec);
+    boost::beast::get_lowest_layer(m_ws).close(ec);
+}
+
+void WebSocketConnection::armTimer(uint64_t delayMs) {
+    // 已有定时器时只在时间轮上挪位置，回调只在第一次创建
+    if (m_timer && m_loop->resetTimer(m_timer, delayMs)) {
+        return;
+    }
+
+    std::weak_ptr<WebSocketConnection> weak =
+        std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    m_timer = m_loop->runAfter(delayMs, [weak] {
+        if (auto self = weak.lock()) {
+            self->m_timer = {};
+            self->onTimer();
+        }
+    });
+}
+
+void WebSocketConnection::cancelTimer() {
+    if (m_timer) {
+        m_loop->cancelTimer(m_timer);
+        m_timer = {};
+    }
+}
+
+void WebSocketConnection::onActivity() {
+    if (!m_handshakeDone || m_closing) {
+        return;
+    }
+    m_awaitingPong = false;
+    armTimer(g_heartbeatOptions.pingIntervalMs);
+}
+
+void WebSocketConnection::onTimer() {
+    if (!m_handshakeDone) {
+        LOG_WARN("handshake timeout, this={}", static_cast<void*>(this));
+        forceClose();
+        return;
+    }
+    if (m_closing) {
+        LOG_WARN("close handshake timeout, this={}", static_cast<void*>(this));
+        forceClose();
+        return;
+    }
+    if (m_awaitingPong) {
+        LOG_WARN("pong timeout, this={}", static_cast<void*>(this));
+        forceClose();
+        return;
+    }
+
+    // 空闲满一个周期：发 ping，在 pongTimeout 内没有任何读到的帧就断开
+    m_awaitingPong = true;
+    armTimer(g_heartbeatOptions.pongTimeoutMs);
+
+    // 上一个 ping 还卡在发送中（对端不读）时不再叠加新的 ping，超时照样断开
+    if (m_pingInFlight) {
+        return;
+    }
+    m_pingInFlight = true;
+
+    auto self = std::static_pointer_cast<WebSocketConnection>(shared_from_this());
+    m_ws.async_ping({},
+        [self](boost::system::error_code ec) {
+            self->m_pingInFlight = false;
+            if (ec) {
+                if (ec != boost::asio::error::operation_aborted) self->fail(ec, "ping");
+                return;
+            }
+            if (self->m_closePending) {
+                self->m_closePending = false;
+                self->sendClose();
+            }
+        });
+}
+
+const std::string& WebSocketConnection::resumeToken() const {
+    return m_resumeToken;
 }
 
 std::string WebSocketConnection::remoteAddr() const {
-    return m_ws.next_layer().remote_endpoint().address().to_string();
+    boost::system::error_code ec;
+    auto ep = boost::beast::get_lowest_layer(m_ws).remote_endpoint(ec);
+    return ec ? "unknown" : ep.address().to_string();
 }
 
 void WebSocketConnection::fail(boost::system::error_code ec,
@@ -1,27 +1,157 @@
 #pragma once
 #include "Connection.h"
+#include "ServerContext.h"
+#include "WsMessageHandler.h"
+#include "GatedSocket.h"
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/core.hpp>
+#include <array>
+#include <deque>
+#include <atomic>
+#ifdef NET_USE_COROUTINES
+#include "Awaitables.h"
+#endif
 
 class WebSocketConnection
     : public Connection {
 public:
+    // 升级请求和握手应答中携带会话恢复令牌的头部
+    static constexpr const char* kResumeTokenHeader = "X-Resume-Token";
+
+    // ---- 慢消费者背压 ----
+    // 队列超过高水位后进入拥塞状态，按 policy 处理新消息，直到排空到低水位以下
+    struct OutboundLimits {
+        enum class Policy {
+            DropOldest,     // 丢弃最早排队（尚未开始写）的消息
+            DropNewest,     // 丢弃新到的消息
+            Disconnect      // 直接断开连接
+        };
+
+        size_t highWatermarkBytes = 4 * 1024 * 1024;
+        size_t highWatermarkMessages = 4096;
+        size_t lowWatermarkBytes = 1024 * 1024;
+        size_t lowWatermarkMessages = 1024;
+        Policy policy = Policy::DropOldest;
+
+        // "drop_oldest" / "drop_newest" / "disconnect"，无法识别时返回 DropOldest
+        static Policy parsePolicy(const std::string& name);
+    };
+
+    // 每种策略触发的累计次数（所有连接合计）
+    struct BackpressureStats {
+        uint64_t droppedOldest = 0;     // 被丢弃的旧消息数
+        uint64_t droppedNewest = 0;     // 被丢弃的新消息数
+        uint64_t disconnects = 0;       // 因积压被断开的连接数
+    };
+
+    // ---- 握手截止时间与心跳（由所属 EventLoop 的时间轮驱动）----
+    struct HeartbeatOptions {
+        uint64_t handshakeTimeoutMs = 10000;    // 握手未完成则断开
+        uint64_t pingIntervalMs = 30000;        // 这么久没读到任何帧就发 ping
+        uint64_t pongTimeoutMs = 10000;         // ping 之后等待回应的时间
+        uint64_t closeTimeoutMs = 5000;         // close 握手的最长时间
+    };
+
+    // 启动时设置一次（NetBootstrap 从 config.json 读取），之后只读
+    static void setOutboundLimits(const OutboundLimits& limits);
+    static const OutboundLimits& outboundLimits();
+    static BackpressureStats backpressureStats();
+    static void setHeartbeatOptions(const HeartbeatOptions& options);
+
     explicit WebSocketConnection(
         boost::asio::ip::tcp::socket socket,
-        boost::beast::http::request<boost::beast::http::string_body> req);
+        boost::beast::http::request<boost::beast::http::string_body> req,
+        Buffer buffer,
+        std::shared_ptr<EventLoop> loop,
+        std::shared_ptr<ServerContext> context);
 
     void start() override;
-    void send(const std::string& msg) override;
+    using Connection::send;
+    void send(MessageBuffer::Ptr msg) override;
+    void sendBatch(std::vector<MessageBuffer::Ptr> msgs) override;
     void close() override;
     std::string remoteAddr() const override;
 
+    // 握手时为所属 Session 签发的恢复令牌（握手应答头中已下发），
+    // 业务层可在登录成功后再次发给客户端；没有 Session 时为空
+    const std::string& resumeToken() const;
+
+    // 把所属用户（Session 已登录）的离线消息取出一批发送，返回条数；只在 loop 线程调用。
+    // 一批写完后才在日志里确认，并接着取下一批。
+    // 握手完成时自动调用一次，登录成功后业务层应再调用一次
+    size_t deliverOffline();
+
+    const std::shared_ptr<ServerContext>& context() const;
+
+    // ---- 发送队列统计（任意线程可读）----
+    size_t queueDepth() const;      // 待发送消息数（含正在写的）
+    size_t queuedBytes() const;     // 待发送字节数
+
 private:
+    // 两种模式共用：返回 false 表示读循环结束
+    bool onAccept(boost::system::error_code ec);
+    bool onRead(boost::system::error_code ec, std::size_t bytes);
+#ifdef NET_USE_COROUTINES
+    // 握手 + 读循环，一个协程顺序写完
+    DetachedTask run();
+#else
     void doRead();
-    void onRead(boost::system::error_code ec, std::size_t bytes);
+#endif
     void fail(boost::system::error_code ec, const std::string& where);
+    void dispatchMessage();
+
+    // ---- 发送队列：只在所属 loop 线程上访问 ----
+    void enqueue(MessageBuffer::Ptr msg);
+    void doWrite();
+    void writeGathered();
+    void onWrite(boost::system::error_code ec, std::size_t bytes);
+    bool overWatermark(size_t depth, size_t bytes, bool high) const;
+    void dropOldest(size_t incomingBytes);
+    void popFront();
+    void clearQueue();
+    void ackOffline();
+    void doClose();
+    void sendClose();
+    void forceClose();
+
+    // ---- 定时器：握手 → 心跳 → 关闭，同一时刻只有一个截止时间 ----
+    void armTimer(uint64_t delayMs);
+    void cancelTimer();
+    void onTimer();
+    void onActivity();
 
 private:
-    boost::beast::websocket::stream<boost::asio::ip::tcp::socket> m_ws;
-    boost::beast::flat_buffer m_buffer;
+    std::shared_ptr<ServerContext> m_context;
+    WsMessageHandler* m_handler = nullptr;  // 由 m_context 持有
+    boost::beast::websocket::stream<GatedSocket> m_ws;
+    Buffer m_buffer;
+    HandlerMemory m_readMemory;     // 读 handler 的复用内存
+    HandlerMemory m_writeMemory;    // 写 handler 的复用内存
     boost::beast::http::request<boost::beast::http::string_body> m_request;
+    std::string m_resumeToken;
+
+    std::deque<MessageBuffer::Ptr> m_outbox;   // 队首 m_writeCount 条为正在写的消息
+    size_t m_writeCount = 0;
+    // ---- 合并写：队列里的多条消息自己编码帧头，帧头和共享 payload 一次 gather 写出 ----
+    static constexpr size_t kMaxGatherMessages = 32;    // 帧头 + payload 共 64 段，asio 一次 sendmsg 的上限
+    static constexpr size_t kMaxGatherBytes = 256 * 1024;
+    std::array<std::array<unsigned char, 10>, kMaxGatherMessages> m_frameHeaders;
+    std::vector<boost::asio::const_buffer> m_gather;
+    bool m_gatherWrites = false;        // 未启用压缩时才能自己编码帧
+    bool m_handshakeDone = false;
+    bool m_writing = false;             // 🔑 同一时刻最多一个写操作
+    bool m_congested = false;           // 超过高水位后置位，回落到低水位以下清除
+    bool m_closing = false;
+    bool m_awaitingPong = false;
+    // 🔑 beast 同一时刻只允许一个 ping/pong/close：ping 未完成时 close 先挂起，ping 完成后再发
+    bool m_pingInFlight = false;
+    bool m_closePending = false;
+    // ---- 离线消息：peek 出的一批按发送顺序跟踪，写完最后一条才 ack ----
+    std::deque<std::pair<const MessageBuffer*, uint64_t>> m_offlineInflight;   // 未写完的消息及其序号
+    uint64_t m_offlineUser = 0;
+    uint64_t m_offlineWrittenSeq = 0;   // 本批已写出的最大序号
+    bool m_offlineDeferred = false;     // 发送队列没有余量，排空后再取
+    EventLoop::TimerId m_timer;
+    std::atomic<size_t> m_queueDepth{0};
+    std::atomic<size_t> m_queuedBytes{0};
 };
@@ -0,0 +1,9 @@
+#include "WsMessageHandler.h"
+#include "WebSocketConnection.h"
+
+void EchoMessageHandler::onText(WebSocketConnection& conn, std::string_view payload) {
+    std::string reply;
+    reply.reserve(6 + payload.size());
+    reply.append("Echo: ").append(payload);
+    conn.send(MessageBuffer::make(std::move(reply)));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string_view>
+#include <boost/asio/buffer.hpp>
+
+class WebSocketConnection;
+
+// WebSocket 消息的业务处理接口，由 NetBootstrap 注册，所有连接共享（需线程安全）。
+// 回调都在连接所属的 loop 线程上执行。
+// payload 直接指向连接读缓冲区中的帧数据，只在回调期间有效，需要保留时自行拷贝；
+// 需要在回调之外持有连接时用 conn.shared_from_this()。
+class WsMessageHandler {
+public:
+    virtual ~WsMessageHandler() = default;
+
+    virtual void onOpen(WebSocketConnection&) {}
+    virtual void onText(WebSocketConnection& conn, std::string_view payload) = 0;
+    virtual void onBinary(WebSocketConnection&, boost::asio::const_buffer) {}
+    virtual void onClose(WebSocketConnection&) {}
+};
+
+// 默认处理：原样回显文本消息
+class EchoMessageHandler : public WsMessageHandler {
+public:
+    void onText(WebSocketConnection& conn, std::string_view payload) override;
+};
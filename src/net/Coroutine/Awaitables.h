@@ -0,0 +1,139 @@
+// Awaitables.h
+#pragma once
+#include <boost/system/error_code.hpp>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include "Task.h"
+#include "EventLoop.h"
+#include "Thread_pool.h"
+
+// ---- 把 asio/beast 的异步操作变成 co_await ----
+// auto [ec, bytes] = co_await asyncIo([&](auto handler) {
+//     http::async_read(socket, buffer, req, makeAllocHandler(mem, std::move(handler)));
+// });
+// handler 只持有协程句柄和结果槽（两个指针），调用方可以继续套 makeAllocHandler 复用内存。
+// 注意：handler 不持有连接，协程帧里要自己持有 shared_ptr。
+struct IoResult {
+    boost::system::error_code ec;
+    std::size_t bytes = 0;
+};
+
+template <class Initiate>
+class IoAwaiter {
+public:
+    explicit IoAwaiter(Initiate initiate) : m_initiate(std::move(initiate)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        m_initiate(Completion{&m_result, handle});
+    }
+
+    IoResult await_resume() const noexcept { return m_result; }
+
+private:
+    struct Completion {
+        IoResult* result;
+        std::coroutine_handle<> handle;
+
+        // 同时适配 void(error_code) 和 void(error_code, size_t)
+        void operator()(boost::system::error_code ec, std::size_t bytes = 0) {
+            *result = IoResult{ec, bytes};
+            handle.resume();
+        }
+    };
+
+    Initiate m_initiate;
+    IoResult m_result;
+};
+
+template <class Initiate>
+IoAwaiter<Initiate> asyncIo(Initiate initiate) {
+    return IoAwaiter<Initiate>(std::move(initiate));
+}
+
+// ---- 挂起直到外部恢复 ----
+// 协程把自己的句柄存进 slot 后挂起；持有 slot 的对象负责 resume，
+// 或者在析构时 destroy（只适用于 DetachedTask 这样的顶层协程）。
+struct ParkAwaiter {
+    std::coroutine_handle<>& slot;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept { slot = handle; }
+    void await_resume() const noexcept {}
+};
+
+// ---- 挂起并放掉协程持有的最后一个引用 ----
+// co_await parkAndRelease(m_parked, std::move(self));
+// 先把句柄登记到 slot，再在 await_suspend 里释放 owner：如果这是最后一个引用，
+// 对象析构时看到 slot 已登记，会直接 destroy 这个（已挂起的）协程帧。
+// 不能先检查 use_count 再 reset：两步之间别的线程放掉引用，reset 就会析构对象，
+// 随后的挂起再写 slot 就是写已释放的内存。
+template <class T>
+struct ParkReleaseAwaiter {
+    std::coroutine_handle<>& slot;
+    std::shared_ptr<T> owner;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept {
+        slot = handle;
+        // 🔑 移到栈上再释放：析构可能销毁协程帧（包括本 awaiter），之后不再访问任何成员
+        std::shared_ptr<T> last = std::move(owner);
+    }
+    void await_resume() const noexcept {}
+};
+
+template <class T>
+ParkReleaseAwaiter<T> parkAndRelease(std::coroutine_handle<>& slot, std::shared_ptr<T> owner) {
+    return ParkReleaseAwaiter<T>{slot, std::move(owner)};
+}
+
+// ---- 阻塞操作（DB、磁盘）放到 ThreadPool，完成后回到 loop 线程继续 ----
+// auto user = co_await runInPool(*conn.loop(), [id] { return db.findUser(id); });
+template <class F>
+class PoolAwaiter {
+public:
+    using Result = std::invoke_result_t<F&>;
+
+    PoolAwaiter(EventLoop& loop, F fn) : m_loop(loop), m_fn(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+        ThreadPool::detach_task([this, handle] {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    m_fn();
+                } else {
+                    m_value.emplace(m_fn());
+                }
+            } catch (...) {
+                m_exception = std::current_exception();
+            }
+            m_loop.post([handle] { handle.resume(); });
+        });
+    }
+
+    Result await_resume() {
+        if (m_exception) std::rethrow_exception(m_exception);
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*m_value);
+        }
+    }
+
+private:
+    using Storage = std::conditional_t<std::is_void_v<Result>, char, Result>;
+
+    EventLoop& m_loop;
+    F m_fn;
+    std::optional<Storage> m_value;
+    std::exception_ptr m_exception;
+};
+
+template <class F>
+PoolAwaiter<F> runInPool(EventLoop& loop, F fn) {
+    return PoolAwaiter<F>(loop, std::move(fn));
+}
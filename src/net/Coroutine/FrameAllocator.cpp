@@ -0,0 +1,60 @@
+// FrameAllocator.cpp
+#include "FrameAllocator.h"
+#include <array>
+#include <new>
+#include <vector>
+
+namespace {
+constexpr size_t kClassCount = FrameAllocator::kMaxFrameSize / FrameAllocator::kGranularity;
+
+size_t classIndex(size_t size) {
+    return (size + FrameAllocator::kGranularity - 1) / FrameAllocator::kGranularity - 1;
+}
+
+struct FrameCache {
+    std::array<std::vector<void*>, kClassCount> free;
+
+    ~FrameCache() {
+        for (auto& list : free) {
+            for (void* p : list) ::operator delete(p);
+        }
+    }
+};
+
+// 🔑 thread_local：分配/释放都不加锁；在别的线程释放的帧进入那个线程的缓存
+thread_local FrameCache t_cache;
+}
+
+void* FrameAllocator::allocate(size_t size) {
+    if (size == 0 || size > kMaxFrameSize) {
+        return ::operator new(size);
+    }
+
+    size_t idx = classIndex(size);
+    auto& list = t_cache.free[idx];
+    if (!list.empty()) {
+        void* p = list.back();
+        list.pop_back();
+        return p;
+    }
+    return ::operator new((idx + 1) * kGranularity);
+}
+
+void FrameAllocator::deallocate(void* p, size_t size) noexcept {
+    if (!p) return;
+    if (size == 0 || size > kMaxFrameSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    auto& list = t_cache.free[classIndex(size)];
+    if (list.size() >= kMaxCachedPerClass) {
+        ::operator delete(p);
+        return;
+    }
+    try {
+        list.push_back(p);
+    } catch (...) {
+        ::operator delete(p);
+    }
+}
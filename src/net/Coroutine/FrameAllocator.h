@@ -0,0 +1,17 @@
+// FrameAllocator.h
+#pragma once
+#include <cstddef>
+
+// 协程帧的回收分配器：每个线程一组按 128 字节分级的空闲链表。
+// 连接的读循环协程在 loop 线程上创建和销毁，帧大小固定，
+// 释放后留给下一个连接复用，不再每次走 malloc。
+// 超过 kMaxFrameSize 的帧直接走 operator new。
+class FrameAllocator {
+public:
+    static constexpr size_t kGranularity = 128;
+    static constexpr size_t kMaxFrameSize = 4096;
+    static constexpr size_t kMaxCachedPerClass = 256;   // 每个线程每级最多缓存的帧数
+
+    static void* allocate(size_t size);
+    static void deallocate(void* p, size_t size) noexcept;
+};
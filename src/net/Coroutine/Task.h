@@ -0,0 +1,156 @@
+// Task.h
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include "FrameAllocator.h"
+#include "Logger.h"
+
+// C++20 协程的最小封装（需要 ENABLE_COROUTINES）：
+// - Task<T>：惰性启动，被 co_await 时才开始执行，结束后对称转移回调用方
+// - DetachedTask：立即启动、结束时自动销毁，用作连接读循环等顶层协程
+// 所有协程帧都从 FrameAllocator 分配。
+// 协程恢复发生在完成回调所在的线程（通常是连接所属的 loop 线程）。
+
+// 协程帧分配走回收池
+struct FramePromise {
+    static void* operator new(size_t size) {
+        return FrameAllocator::allocate(size);
+    }
+    static void operator delete(void* p, size_t size) noexcept {
+        FrameAllocator::deallocate(p, size);
+    }
+};
+
+template <class T = void>
+class Task;
+
+namespace task_detail {
+
+struct PromiseBase : FramePromise {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+            // 🔑 对称转移：直接恢复调用方，调用链再深也不会增长栈
+            auto next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& v) {
+        value.emplace(std::forward<U>(v));
+    }
+
+    T result() {
+        if (exception) std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+}
+
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = task_detail::Promise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : m_handle(handle) {}
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (m_handle) m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (m_handle) m_handle.destroy();
+    }
+
+    // ---- awaitable ----
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+        m_handle.promise().continuation = caller;
+        return m_handle;
+    }
+
+    T await_resume() {
+        return m_handle.promise().result();
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace task_detail {
+
+template <class T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+}
+
+// 顶层协程：调用即开始执行，结束时帧自动释放；异常只记录日志
+struct DetachedTask {
+    struct promise_type : FramePromise {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                LOG_ERROR("detached coroutine error: {}", e.what());
+            } catch (...) {
+                LOG_ERROR("detached coroutine error: unknown exception");
+            }
+        }
+    };
+};
+
+// 在当前线程启动一个 Task，不等待其结果
+inline DetachedTask spawnTask(Task<void> task) {
+    co_await std::move(task);
+}
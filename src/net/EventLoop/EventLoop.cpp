@@ -2,10 +2,26 @@
 #include "EventLoop.h"
 #include "Logger.h"
 
-EventLoop::EventLoop()
-    : m_ioContext(),
-      m_workGuard(boost::asio::make_work_guard(m_ioContext)) {
-    LOG_INFO("Created");
+namespace {
+std::atomic<uint64_t> g_lagWarnNs{200 * 1000 * 1000};
+
+uint64_t toNs(std::chrono::steady_clock::duration d) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+}
+
+void EventLoop::setLagWarnThreshold(uint64_t ms) {
+    g_lagWarnNs.store(ms * 1000 * 1000, std::memory_order_relaxed);
+}
+
+EventLoop::EventLoop(size_t index, uint64_t tickMs)
+    : m_index(index),
+      m_ioContext(),
+      m_workGuard(boost::asio::make_work_guard(m_ioContext)),
+      m_memoryPool(std::make_shared<MemoryPool>()),
+      m_tick(std::max<uint64_t>(tickMs, 1)),
+      m_tickTimer(m_ioContext) {
+    LOG_INFO("Created, index={}, tick={}ms", m_index, m_tick.count());
 }
 
 EventLoop::~EventLoop() {
@@ -18,9 +34,11 @@ EventLoop::~EventLoop() {
 }
 
 void EventLoop::run() {
-    LOG_INFO("run() called, starting thread");
+    LOG_INFO("run() called, starting thread, index={}", m_index);
+    m_nextTick = std::chrono::steady_clock::now() + m_tick;
+    scheduleTick();
     m_thread = std::thread([this]{
-        LOG_INFO("Thread started, running io_context");
+        LOG_INFO("Thread started, running io_context, index={}", m_index);
         m_ioContext.run();
         LOG_INFO("io_context.run() exited");
     });
@@ -33,7 +51,15 @@ void EventLoop::stop() {
 
 void EventLoop::post(std::function<void()> cb) {
     LOG_DEBUG("post() called");
-    boost::asio::post(m_ioContext, std::move(cb));
+
+    // 🔑 记录投递时刻，执行时得到排队时间；再加上任务本身的执行时间
+    uint64_t queued = LoopClock::now();
+    boost::asio::post(m_ioContext, [this, queued, cb = std::move(cb)] {
+        uint64_t start = LoopClock::now();
+        m_stats.record(LoopStats::Kind::PostDelay, LoopClock::toNs(start - queued));
+        cb();
+        m_stats.record(LoopStats::Kind::Task, LoopClock::toNs(LoopClock::now() - start));
+    });
 }
 
 boost::asio::io_context &EventLoop::getIOContext()
@@ -41,3 +67,81 @@ boost::asio::io_context &EventLoop::getIOContext()
     LOG_DEBUG("getIOContext() called");
     return m_ioContext;
 }
+
+bool EventLoop::isInLoopThread() {
+    return m_ioContext.get_executor().running_in_this_thread();
+}
+
+size_t EventLoop::index() const {
+    return m_index;
+}
+
+void EventLoop::addConnection() {
+    m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventLoop::removeConnection() {
+    m_connectionCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t EventLoop::connectionCount() const {
+    return m_connectionCount.load(std::memory_order_relaxed);
+}
+
+const std::shared_ptr<MemoryPool>& EventLoop::memoryPool() const {
+    return m_memoryPool;
+}
+
+LoopStats& EventLoop::stats() {
+    return m_stats;
+}
+
+const LoopStats& EventLoop::stats() const {
+    return m_stats;
+}
+
+EventLoop::TimerId EventLoop::runAfter(uint64_t delayMs, TimingWheel::Callback cb) {
+    return m_wheel.schedule(toTicks(delayMs), std::move(cb));
+}
+
+bool EventLoop::resetTimer(TimerId id, uint64_t delayMs) {
+    return m_wheel.reschedule(id, toTicks(delayMs));
+}
+
+void EventLoop::cancelTimer(TimerId id) {
+    m_wheel.cancel(id);
+}
+
+uint64_t EventLoop::toTicks(uint64_t delayMs) const {
+    uint64_t tick = static_cast<uint64_t>(m_tick.count());
+    return (delayMs + tick - 1) / tick;
+}
+
+void EventLoop::scheduleTick() {
+    // 整个 loop 只用一个 steady_timer 驱动时间轮，按绝对时间推进避免累积误差
+    m_tickTimer.expires_at(m_nextTick);
+    m_tickTimer.async_wait([this](boost::system::error_code ec) {
+        if (ec) return;
+
+        // 🔑 tick 本身就是周期性探针：实际触发时间比预定时间晚多少，就是 loop 被占用了多久
+        auto now = std::chrono::steady_clock::now();
+        uint64_t lag = now > m_nextTick ? toNs(now - m_nextTick) : 0;
+        m_stats.recordLag(lag);
+
+        uint64_t warnNs = g_lagWarnNs.load(std::memory_order_relaxed);
+        if (warnNs != 0 && lag > warnNs && now - m_lastLagWarn >= std::chrono::seconds(1)) {
+            m_lastLagWarn = now;
+            LOG_WARN("event loop lagging, index={}, lag={}ms, connections={}",
+                     m_index, lag / 1000000, connectionCount());
+        }
+
+        {
+            LoopStatsScope scope(m_stats, LoopStats::Kind::Timer);
+            while (m_nextTick <= now) {
+                m_wheel.tick();
+                m_nextTick += m_tick;
+            }
+        }
+        scheduleTick();
+    });
+}
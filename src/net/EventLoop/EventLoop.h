@@ -4,19 +4,68 @@
 #include <thread>
 #include <memory>
 #include <functional>
+#include <atomic>
+#include "MemoryPool.h"
+#include "TimingWheel.h"
+#include "LoopStats.h"
 
 class EventLoop {
 public:
-    EventLoop();
+    using TimerId = TimingWheel::TimerId;
+
+    // tickMs: 时间轮精度
+    explicit EventLoop(size_t index = 0, uint64_t tickMs = 100);
     ~EventLoop();
 
     void run();                         // 启动事件循环
     void stop();                        // 停止事件循环
     void post(std::function<void()> cb); // 投递任务到 io_context
     boost::asio::io_context& getIOContext();
+    bool isInLoopThread();              // 当前线程是否正在运行本 loop
+
+    size_t index() const;               // 在 EventLoopPool 中的下标
+
+    // ---- 连接计数（供负载均衡和监控使用）----
+    void addConnection();
+    void removeConnection();
+    size_t connectionCount() const;
+
+    // ---- 定时器（分层时间轮），只能在本 loop 线程上调用 ----
+    // 精度为一个 tick；回调在本 loop 线程执行
+    TimerId runAfter(uint64_t delayMs, TimingWheel::Callback cb);
+    // 从现在起重新计时，O(1)，适合每次读完成时调用；定时器已触发/取消时返回 false
+    bool resetTimer(TimerId id, uint64_t delayMs);
+    void cancelTimer(TimerId id);
+
+    // 本 loop 上连接对象及其缓冲区的内存池
+    const std::shared_ptr<MemoryPool>& memoryPool() const;
+
+    // ---- 延迟统计 ----
+    // handler 中用 LoopStatsScope scope(loop->stats(), LoopStats::Kind::HttpRead) 计时；
+    // 快照可在任意线程读取
+    LoopStats& stats();
+    const LoopStats& stats() const;
+
+    // loop 滞后超过该值时打 warning（每秒最多一次），0 表示不告警；启动时设置一次
+    static void setLagWarnThreshold(uint64_t ms);
+
+private:
+    void scheduleTick();
+    uint64_t toTicks(uint64_t delayMs) const;
 
 private:
+    size_t m_index;
     boost::asio::io_context m_ioContext;
     boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_workGuard;
     std::thread m_thread;
+    std::atomic<size_t> m_connectionCount{0};
+    std::shared_ptr<MemoryPool> m_memoryPool;
+
+    TimingWheel m_wheel;
+    std::chrono::milliseconds m_tick;
+    boost::asio::steady_timer m_tickTimer;
+    std::chrono::steady_clock::time_point m_nextTick;
+
+    LoopStats m_stats;
+    std::chrono::steady_clock::time_point m_lastLagWarn;
 };
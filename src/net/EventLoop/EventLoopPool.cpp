@@ -0,0 +1,82 @@
+// EventLoopPool.cpp
+#include "EventLoopPool.h"
+#include "Logger.h"
+
+EventLoopPool::EventLoopPool(size_t size, Strategy strategy, uint64_t tickMs)
+    : m_strategy(strategy) {
+    if (size == 0) size = 1;
+
+    m_loops.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        m_loops.push_back(std::make_shared<EventLoop>(i, tickMs));
+    }
+
+    LOG_INFO("Created, size={}, strategy={}", size,
+             m_strategy == Strategy::RoundRobin ? "round_robin" : "least_connections");
+}
+
+EventLoopPool::~EventLoopPool() {
+    LOG_INFO("Destroyed");
+    stop();
+}
+
+void EventLoopPool::start() {
+    LOG_INFO("start() called, loops={}", m_loops.size());
+    for (auto& loop : m_loops) {
+        loop->run();
+    }
+}
+
+void EventLoopPool::stop() {
+    for (auto& loop : m_loops) {
+        loop->stop();
+    }
+}
+
+std::shared_ptr<EventLoop> EventLoopPool::getNextLoop() {
+    if (m_strategy == Strategy::LeastConnections) {
+        // loop 数量很少（通常等于核数），线性扫描即可
+        size_t best = 0;
+        size_t bestCount = m_loops[0]->connectionCount();
+        for (size_t i = 1; i < m_loops.size(); ++i) {
+            size_t count = m_loops[i]->connectionCount();
+            if (count < bestCount) {
+                best = i;
+                bestCount = count;
+            }
+        }
+        return m_loops[best];
+    }
+
+    size_t idx = m_next.fetch_add(1, std::memory_order_relaxed) % m_loops.size();
+    return m_loops[idx];
+}
+
+std::shared_ptr<EventLoop> EventLoopPool::getLoop(size_t index) const {
+    return m_loops.at(index);
+}
+
+const std::vector<std::shared_ptr<EventLoop>>& EventLoopPool::loops() const {
+    return m_loops;
+}
+
+size_t EventLoopPool::size() const {
+    return m_loops.size();
+}
+
+std::vector<size_t> EventLoopPool::connectionCounts() const {
+    std::vector<size_t> counts;
+    counts.reserve(m_loops.size());
+    for (const auto& loop : m_loops) {
+        counts.push_back(loop->connectionCount());
+    }
+    return counts;
+}
+
+EventLoopPool::Strategy EventLoopPool::parseStrategy(const std::string& name) {
+    if (name == "least_connections") return Strategy::LeastConnections;
+    if (name != "round_robin") {
+        LOG_WARN("Unknown loop balance strategy '{}', fallback to round_robin", name);
+    }
+    return Strategy::RoundRobin;
+}
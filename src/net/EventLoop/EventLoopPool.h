@@ -0,0 +1,42 @@
+// EventLoopPool.h
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+
+#include "EventLoop.h"
+
+// 一组 worker EventLoop，每个 loop 独占一个线程。
+// Acceptor 只负责 accept，新连接通过 getNextLoop() 分配到某个 worker loop 上。
+class EventLoopPool {
+public:
+    enum class Strategy {
+        RoundRobin,         // 轮询
+        LeastConnections    // 选择当前连接数最少的 loop
+    };
+
+    EventLoopPool(size_t size, Strategy strategy = Strategy::RoundRobin, uint64_t tickMs = 100);
+    ~EventLoopPool();
+
+    void start();   // 启动所有 loop 线程
+    void stop();    // 停止所有 loop
+
+    // 按负载均衡策略挑选一个 worker loop
+    std::shared_ptr<EventLoop> getNextLoop();
+
+    std::shared_ptr<EventLoop> getLoop(size_t index) const;
+    const std::vector<std::shared_ptr<EventLoop>>& loops() const;
+    size_t size() const;
+
+    // 每个 loop 当前的连接数（监控用），下标与 getLoop(index) 对应
+    std::vector<size_t> connectionCounts() const;
+
+    // "round_robin" / "least_connections"，无法识别时返回 RoundRobin
+    static Strategy parseStrategy(const std::string& name);
+
+private:
+    std::vector<std::shared_ptr<EventLoop>> m_loops;
+    Strategy m_strategy;
+    std::atomic<size_t> m_next{0};
+};
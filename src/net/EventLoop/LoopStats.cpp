@@ -0,0 +1,88 @@
+// LoopStats.cpp
+#include "LoopStats.h"
+#include <algorithm>
+#include <thread>
+
+namespace {
+double calibrateNsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    // 启动时用 10ms 对 steady_clock 校准 TSC 频率
+    auto t0 = std::chrono::steady_clock::now();
+    uint64_t c0 = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto t1 = std::chrono::steady_clock::now();
+    uint64_t c1 = __rdtsc();
+    double ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+    return c1 > c0 ? ns / static_cast<double>(c1 - c0) : 1.0;
+#else
+    using period = std::chrono::steady_clock::period;
+    return 1e9 * period::num / period::den;
+#endif
+}
+
+const char* const kKindNames[LoopStats::kKindCount] = {
+    "accept", "http_read", "ws_read", "write", "task", "timer", "post_delay", "lag"
+};
+}
+
+double LoopClock::s_nsPerTick = calibrateNsPerTick();
+
+const char* LoopStats::kindName(Kind kind) {
+    return kKindNames[static_cast<size_t>(kind)];
+}
+
+uint64_t LoopStats::HistogramSnapshot::percentileNs(double p) const {
+    if (count == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(static_cast<double>(count) * p);
+    if (target >= count) target = count - 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen > target) {
+            // 桶 i 的上界为 2^i - 1，不超过实际观测到的最大值
+            uint64_t upper = i == 0 ? 0 : (i >= 64 ? UINT64_MAX : (uint64_t(1) << i) - 1);
+            return std::min(upper, maxNs);
+        }
+    }
+    return maxNs;
+}
+
+LoopStats::Snapshot LoopStats::snapshot() const {
+    // 各字段分别读取，并发写入时快照可能不是严格一致的，用于监控足够
+    Snapshot snap;
+    for (size_t k = 0; k < kKindCount; ++k) {
+        const Histogram& h = m_histograms[k];
+        HistogramSnapshot& out = snap.kinds[k];
+        for (size_t i = 0; i < kBuckets; ++i) {
+            out.buckets[i] = h.buckets[i].load(std::memory_order_relaxed);
+        }
+        out.count = h.count.load(std::memory_order_relaxed);
+        out.sumNs = h.sumNs.load(std::memory_order_relaxed);
+        out.maxNs = h.maxNs.load(std::memory_order_relaxed);
+    }
+    snap.lastLagNs = m_lastLagNs.load(std::memory_order_relaxed);
+    return snap;
+}
+
+std::string LoopStats::format(const Snapshot& snap) {
+    std::string out;
+    for (size_t k = 0; k < kKindCount; ++k) {
+        const HistogramSnapshot& h = snap.kinds[k];
+        if (h.count == 0) continue;
+        if (!out.empty()) out += ' ';
+        out += kKindNames[k];
+        out += '=';
+        out += std::to_string(h.count);
+        out += '/';
+        out += std::to_string(h.percentileNs(0.5) / 1000);
+        out += '/';
+        out += std::to_string(h.percentileNs(0.99) / 1000);
+        out += '/';
+        out += std::to_string(h.maxNs / 1000);
+    }
+    if (out.empty()) out = "idle";
+    return out + " (count/p50/p99/max us)";
+}
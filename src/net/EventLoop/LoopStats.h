@@ -0,0 +1,132 @@
+// LoopStats.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 低开销计时源：x86 上直接读 TSC（constant_tsc，启动时对 steady_clock 校准一次），
+// 其它平台退回 steady_clock。只用于统计耗时，不用于定时
+class LoopClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static uint64_t toNs(uint64_t ticks) {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * s_nsPerTick);
+    }
+
+private:
+    static double s_nsPerTick;
+};
+
+// EventLoop 的延迟统计：按 handler 类型分别记录执行耗时，外加 post 排队时间和 loop 滞后。
+// - 每个直方图 64 个 log2 桶（纳秒），记录一次只是几次 relaxed load/store，无锁无分配
+// - 只有所属 loop 线程写，其它线程（监控、/debug 接口）可随时读快照
+class LoopStats {
+public:
+    enum class Kind : uint8_t {
+        Accept,         // accept 完成
+        HttpRead,       // HTTP 请求读完成（含路由分发）
+        WsRead,         // WebSocket 消息读完成（含业务 handler）
+        Write,          // 写完成
+        Task,           // 通过 EventLoop::post 投递的任务
+        Timer,          // 时间轮 tick（含到期回调）
+        PostDelay,      // post 任务从投递到开始执行的排队时间
+        Lag,            // loop 滞后：时间轮 tick 实际触发时间比预期晚多少
+        Count
+    };
+
+    static constexpr size_t kKindCount = static_cast<size_t>(Kind::Count);
+    static constexpr size_t kBuckets = 64;
+
+    struct HistogramSnapshot {
+        uint64_t count = 0;
+        uint64_t sumNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint64_t, kBuckets> buckets{};
+
+        // 按桶估算分位数（返回桶上界，误差在 2 倍以内）
+        uint64_t percentileNs(double p) const;
+        uint64_t meanNs() const { return count ? sumNs / count : 0; }
+    };
+
+    struct Snapshot {
+        std::array<HistogramSnapshot, kKindCount> kinds;
+        uint64_t lastLagNs = 0;
+    };
+
+    static const char* kindName(Kind kind);
+
+    // 🔑 单写者：只在所属 loop 线程调用，因此用 load + store 代替带 lock 前缀的 fetch_add
+    void record(Kind kind, uint64_t ns) {
+        Histogram& h = m_histograms[static_cast<size_t>(kind)];
+        bump(h.buckets[bucketOf(ns)], 1);
+        bump(h.count, 1);
+        bump(h.sumNs, ns);
+        if (ns > h.maxNs.load(std::memory_order_relaxed)) {
+            h.maxNs.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void recordLag(uint64_t ns) {
+        record(Kind::Lag, ns);
+        m_lastLagNs.store(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t lastLagNs() const { return m_lastLagNs.load(std::memory_order_relaxed); }
+
+    Snapshot snapshot() const;
+
+    // 单行摘要，便于直接写日志：kind=count/p50/p99/max ...
+    static std::string format(const Snapshot& snap);
+
+private:
+    struct Histogram {
+        std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sumNs{0};
+        std::atomic<uint64_t> maxNs{0};
+    };
+
+    static void bump(std::atomic<uint64_t>& v, uint64_t n) {
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // 桶 i 覆盖 [2^(i-1), 2^i) 纳秒，桶 0 只有 0
+    static size_t bucketOf(uint64_t ns) {
+        size_t i = ns == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(ns));
+        return i < kBuckets ? i : kBuckets - 1;
+    }
+
+    std::array<Histogram, kKindCount> m_histograms;
+    std::atomic<uint64_t> m_lastLagNs{0};
+};
+
+// 作用域计时：析构时把经过的时间记到对应直方图
+class LoopStatsScope {
+public:
+    LoopStatsScope(LoopStats& stats, LoopStats::Kind kind)
+        : m_stats(stats), m_kind(kind), m_start(LoopClock::now()) {}
+
+    ~LoopStatsScope() {
+        m_stats.record(m_kind, LoopClock::toNs(LoopClock::now() - m_start));
+    }
+
+    LoopStatsScope(const LoopStatsScope&) = delete;
+    LoopStatsScope& operator=(const LoopStatsScope&) = delete;
+
+private:
+    LoopStats& m_stats;
+    LoopStats::Kind m_kind;
+    uint64_t m_start;
+};
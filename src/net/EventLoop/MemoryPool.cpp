@@ -0,0 +1,75 @@
+// MemoryPool.cpp
+#include "MemoryPool.h"
+#include <new>
+
+MemoryPool::MemoryPool(size_t maxCachedBytes)
+    : m_maxCachedBytes(maxCachedBytes) {
+}
+
+MemoryPool::~MemoryPool() {
+    for (auto& list : m_free) {
+        for (void* p : list) {
+            ::operator delete(p);
+        }
+    }
+}
+
+size_t MemoryPool::classIndex(size_t size) {
+    size_t idx = 0;
+    size_t block = kMinBlockSize;
+    while (block < size) {
+        block <<= 1;
+        ++idx;
+    }
+    return idx;
+}
+
+void* MemoryPool::allocate(size_t size) {
+    if (size > kMaxBlockSize) {
+        return ::operator new(size);
+    }
+
+    size_t idx = classIndex(size);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_allocations;
+        auto& list = m_free[idx];
+        if (!list.empty()) {
+            void* p = list.back();
+            list.pop_back();
+            m_cachedBytes -= kMinBlockSize << idx;
+            ++m_reused;
+            return p;
+        }
+    }
+    return ::operator new(kMinBlockSize << idx);
+}
+
+void MemoryPool::deallocate(void* p, size_t size) {
+    if (!p) return;
+    if (size > kMaxBlockSize) {
+        ::operator delete(p);
+        return;
+    }
+
+    size_t idx = classIndex(size);
+    size_t blockSize = kMinBlockSize << idx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_cachedBytes + blockSize <= m_maxCachedBytes) {
+            m_free[idx].push_back(p);
+            m_cachedBytes += blockSize;
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
+MemoryPool::Stats MemoryPool::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats s;
+    s.allocations = m_allocations;
+    s.reused = m_reused;
+    s.cachedBytes = m_cachedBytes;
+    return s;
+}
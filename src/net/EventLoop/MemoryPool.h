@@ -0,0 +1,76 @@
+// MemoryPool.h
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 按 2 的幂分级的定长块空闲链表，每个 EventLoop 一个。
+// 连接对象（含 shared_ptr 控制块）和它们的读缓冲区从这里分配，
+// 释放后留在空闲链表中供下一个连接复用，连接频繁建立/断开时不再反复走 malloc。
+// 释放可能发生在其它线程（最后一个 shared_ptr 在别处析构），因此用互斥锁保护。
+class MemoryPool {
+public:
+    static constexpr size_t kMinBlockSize = 64;
+    static constexpr size_t kMaxBlockSize = 16 * 1024;
+    static constexpr size_t kClassCount = 9;     // 64 .. 16K
+
+    struct Stats {
+        uint64_t allocations = 0;   // 走池子的分配次数
+        uint64_t reused = 0;        // 其中命中空闲链表的次数
+        size_t cachedBytes = 0;     // 空闲链表中缓存的字节数
+    };
+
+    explicit MemoryPool(size_t maxCachedBytes = 32 * 1024 * 1024);
+    ~MemoryPool();
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size);
+
+    Stats stats() const;
+
+private:
+    static size_t classIndex(size_t size);
+
+    mutable std::mutex m_mutex;
+    std::array<std::vector<void*>, kClassCount> m_free;
+    size_t m_cachedBytes = 0;
+    size_t m_maxCachedBytes;
+    uint64_t m_allocations = 0;
+    uint64_t m_reused = 0;
+};
+
+// 从 MemoryPool 分配的 STL 风格 allocator，可用于 std::allocate_shared 和 beast::basic_flat_buffer
+template <class T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<MemoryPool> pool) noexcept : m_pool(std::move(pool)) {}
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : m_pool(other.m_pool) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(m_pool->allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        m_pool->deallocate(p, sizeof(T) * n);
+    }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept { return m_pool == other.m_pool; }
+    template <class U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept { return m_pool != other.m_pool; }
+
+private:
+    template <class> friend class PoolAllocator;
+    // 🔑 持有 shared_ptr：连接可能比 EventLoop 活得更久，池子要等最后一块内存归还后才销毁
+    std::shared_ptr<MemoryPool> m_pool;
+};
@@ -0,0 +1,128 @@
+// TimingWheel.cpp
+#include "TimingWheel.h"
+#include <algorithm>
+
+TimingWheel::TimingWheel() : m_nodes(1) {
+    std::fill(std::begin(m_heads), std::end(m_heads), kNil);
+}
+
+TimingWheel::TimerId TimingWheel::schedule(uint64_t ticks, Callback cb) {
+    uint32_t index;
+    if (!m_freeList.empty()) {
+        index = m_freeList.back();
+        m_freeList.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+
+    Node& node = m_nodes[index];
+    node.expire = m_now + std::max<uint64_t>(ticks, 1);
+    node.cb = std::move(cb);
+    node.active = true;
+    insert(index);
+    ++m_active;
+
+    return TimerId{index, node.generation};
+}
+
+bool TimingWheel::reschedule(TimerId id, uint64_t ticks) {
+    Node* node = get(id);
+    if (!node) return false;
+
+    unlink(id.index);
+    node->expire = m_now + std::max<uint64_t>(ticks, 1);
+    insert(id.index);
+    return true;
+}
+
+void TimingWheel::cancel(TimerId id) {
+    if (!get(id)) return;
+    unlink(id.index);
+    release(id.index);
+}
+
+void TimingWheel::tick() {
+    ++m_now;
+
+    // 低层转完一圈时，把上一层当前槽里的定时器重新分配到下层
+    for (uint32_t level = 1; level < kLevels; ++level) {
+        if ((m_now & ((uint64_t(1) << (kSlotBits * level)) - 1)) != 0) break;
+        cascade(level);
+    }
+
+    uint32_t slot = static_cast<uint32_t>(m_now & kSlotMask);
+    while (m_heads[slot] != kNil) {
+        uint32_t index = m_heads[slot];
+        unlink(index);
+
+        // 先释放节点再回调，回调里可以安全地 schedule / cancel
+        Callback cb = std::move(m_nodes[index].cb);
+        release(index);
+        if (cb) cb();
+    }
+}
+
+TimingWheel::Node* TimingWheel::get(TimerId id) {
+    if (id.index == kNil || id.index >= m_nodes.size()) return nullptr;
+    Node& node = m_nodes[id.index];
+    if (!node.active || node.generation != id.generation) return nullptr;
+    return &node;
+}
+
+void TimingWheel::insert(uint32_t index) {
+    Node& node = m_nodes[index];
+    // schedule/reschedule 保证 expire > m_now；级联时 expire == m_now 的节点
+    // 落入当前槽，在本次 tick 中触发
+    uint64_t expire = std::max(node.expire, m_now);
+    uint64_t delta = expire - m_now;
+
+    uint32_t level = 0;
+    while (level + 1 < kLevels && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    if (level == kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * kLevels))) {
+        // 超出时间轮范围，先放到最远处，转到时会继续级联
+        expire = m_now + (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+    }
+
+    uint32_t slot = level * kSlots + static_cast<uint32_t>((expire >> (kSlotBits * level)) & kSlotMask);
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = m_heads[slot];
+    if (node.next != kNil) m_nodes[node.next].prev = index;
+    m_heads[slot] = index;
+}
+
+void TimingWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    if (node.prev != kNil) {
+        m_nodes[node.prev].next = node.next;
+    } else {
+        m_heads[node.slot] = node.next;
+    }
+    if (node.next != kNil) m_nodes[node.next].prev = node.prev;
+    node.prev = node.next = kNil;
+}
+
+void TimingWheel::cascade(uint32_t level) {
+    uint32_t slot = level * kSlots +
+                    static_cast<uint32_t>((m_now >> (kSlotBits * level)) & kSlotMask);
+    uint32_t index = m_heads[slot];
+    m_heads[slot] = kNil;
+
+    while (index != kNil) {
+        uint32_t next = m_nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void TimingWheel::release(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.active = false;
+    node.cb = nullptr;
+    ++node.generation;
+    m_freeList.push_back(index);
+    --m_active;
+}
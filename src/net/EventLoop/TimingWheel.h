@@ -0,0 +1,64 @@
+// TimingWheel.h
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 分层时间轮（4 层 × 64 槽），用于大量连接的空闲超时、心跳和握手截止时间。
+// - schedule / cancel / reschedule 都是 O(1)，reschedule 只移动节点、不重建回调，
+//   可以在每次读完成时重新计时
+// - 定时器节点放在内部数组中复用，TimerId 带 generation，过期/取消后的旧 id 自动失效
+// - 非线程安全：只能在所属 EventLoop 的线程上使用
+class TimingWheel {
+public:
+    struct TimerId {
+        uint32_t index = 0;         // 0 表示无效
+        uint32_t generation = 0;
+
+        explicit operator bool() const { return index != 0; }
+    };
+
+    using Callback = std::function<void()>;
+
+    TimingWheel();
+
+    // ticks 个 tick 之后触发（至少 1 个 tick）
+    TimerId schedule(uint64_t ticks, Callback cb);
+    // 重新计时为从现在起 ticks 个 tick；定时器已触发或已取消时返回 false
+    bool reschedule(TimerId id, uint64_t ticks);
+    void cancel(TimerId id);
+
+    // 推进一个 tick，触发到期的定时器
+    void tick();
+
+    size_t size() const { return m_active; }
+
+private:
+    static constexpr uint32_t kLevels = 4;
+    static constexpr uint32_t kSlotBits = 6;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kSlotMask = kSlots - 1;
+    static constexpr uint32_t kNil = 0;
+
+    struct Node {
+        uint32_t prev = kNil;
+        uint32_t next = kNil;
+        uint32_t generation = 0;
+        uint32_t slot = 0;          // level * kSlots + slot，插入后有效
+        uint64_t expire = 0;
+        bool active = false;
+        Callback cb;
+    };
+
+    Node* get(TimerId id);
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(uint32_t level);
+    void release(uint32_t index);
+
+    std::vector<Node> m_nodes;              // m_nodes[0] 不使用
+    std::vector<uint32_t> m_freeList;
+    uint32_t m_heads[kLevels * kSlots];     // 每个槽的链表头
+    uint64_t m_now = 0;                     // 当前 tick
+    size_t m_active = 0;
+};
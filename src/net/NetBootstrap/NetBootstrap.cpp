@@ -1,44 +1,241 @@
 // NetBootstrap.cpp
 #include "NetBootstrap.h"
 #include "Logger.h"
+#include "Config.h"
 #include <thread>
+#include <algorithm>
 
-NetBootstrap::NetBootstrap() = default;
+namespace {
+// 在 loop 线程上每隔 intervalMs 执行一次 fn，fn 返回 false 时停止
+void runEvery(EventLoop* loop, uint64_t intervalMs, std::function<bool()> fn) {
+    loop->runAfter(intervalMs, [loop, intervalMs, fn = std::move(fn)]() mutable {
+        if (fn()) {
+            runEvery(loop, intervalMs, std::move(fn));
+        }
+    });
+}
+}
+
+NetBootstrap::NetBootstrap()
+    : m_router(std::make_shared<HttpRouter>()),
+      m_wsHandler(std::make_shared<EchoMessageHandler>()),
+      m_rooms(std::make_shared<RoomManager>()) {
+}
 
 NetBootstrap::~NetBootstrap() {
     stop();
 }
 
 void NetBootstrap::start(uint16_t port) {
-    // 1. 创建 EventLoop
-    m_loop = std::make_shared<EventLoop>();
+    // 1. 创建 accept EventLoop（时间轮 tick 粒度决定所有连接超时的精度）
+    uint64_t tickMs = static_cast<uint64_t>(std::max(1, Config::getInt("server.timer_tick_ms", 100)));
+    EventLoop::setLagWarnThreshold(std::max(0, Config::getInt("server.lag_warn_ms", 200)));
+    m_loop = std::make_shared<EventLoop>(0, tickMs);
+
+    // 2. 创建 worker EventLoop 池，默认每个核一个 loop
+    size_t ioThreads = static_cast<size_t>(std::max(0, Config::getInt("server.io_threads", 0)));
+    if (ioThreads == 0) {
+        ioThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    auto strategy = EventLoopPool::parseStrategy(
+        Config::getString("server.loop_balance", "round_robin"));
+    m_loopPool = std::make_shared<EventLoopPool>(ioThreads, strategy, tickMs);
+
+    // 3. 连接相关配置：WebSocket 发送队列背压与心跳、HTTP keep-alive
+    WebSocketConnection::OutboundLimits limits;
+    limits.highWatermarkBytes = Config::getInt("websocket.high_watermark_bytes", 4 * 1024 * 1024);
+    limits.highWatermarkMessages = Config::getInt("websocket.high_watermark_messages", 4096);
+    limits.lowWatermarkBytes = Config::getInt("websocket.low_watermark_bytes", 1024 * 1024);
+    limits.lowWatermarkMessages = Config::getInt("websocket.low_watermark_messages", 1024);
+    limits.policy = WebSocketConnection::OutboundLimits::parsePolicy(
+        Config::getString("websocket.overflow_policy", "drop_oldest"));
+    WebSocketConnection::setOutboundLimits(limits);
+
+    WebSocketConnection::HeartbeatOptions heartbeat;
+    heartbeat.handshakeTimeoutMs = Config::getInt("websocket.handshake_timeout_ms", 10000);
+    heartbeat.pingIntervalMs = Config::getInt("websocket.ping_interval_ms", 30000);
+    heartbeat.pongTimeoutMs = Config::getInt("websocket.pong_timeout_ms", 10000);
+    heartbeat.closeTimeoutMs = Config::getInt("websocket.close_timeout_ms", 5000);
+    WebSocketConnection::setHeartbeatOptions(heartbeat);
+
+    HttpConnection::KeepAliveOptions keepAlive;
+    keepAlive.idleTimeoutMs = Config::getInt("http.keep_alive_timeout_ms", 5000);
+    keepAlive.maxRequests = Config::getInt("http.max_keep_alive_requests", 100);
+    HttpConnection::setKeepAliveOptions(keepAlive);
+
+    // 4. 创建 SessionManager（断线重连：恢复令牌 + 断开后的滑动过期）
+    SessionManager::Options sessionOptions;
+    sessionOptions.secret = Config::getString("session.resume_secret", "");
+    sessionOptions.tokenTtlSec = Config::getInt("session.resume_token_ttl_sec", 24 * 3600);
+    sessionOptions.defaultTtlMs = Config::getInt("session.ttl_ms", 60000);
+    sessionOptions.sweepBatch = Config::getInt("session.sweep_batch", 1024);
+    sessionOptions.presenceBuckets = Config::getInt("session.presence_buckets", 65536);
+    m_sessionManager = std::make_shared<SessionManager>(sessionOptions);
+
+    // 热重启：开始 accept 之前挂上上次停服写出的快照。
+    // 没配置 resume_secret 时每次启动随机生成密钥，快照里的 Session 不可能再被恢复令牌找回，
+    // 写快照和加载快照都是白做，直接跳过
+    m_snapshotPath = Config::getString("session.snapshot_path", "");
+    if (!m_snapshotPath.empty() && sessionOptions.secret.empty()) {
+        LOG_WARN("session.snapshot_path is set but session.resume_secret is empty, snapshot disabled");
+        m_snapshotPath.clear();
+    }
+    if (!m_snapshotPath.empty()) {
+        m_sessionManager->loadSnapshot(m_snapshotPath);
+    }
+
+    // 在线索引的读者就是各个 loop 线程，必须在它们开始处理连接之前登记
+    std::vector<std::pair<EventLoop*, size_t>> presenceReaders;
+    presenceReaders.emplace_back(m_loop.get(), m_sessionManager->presence()->registerReader());
+    for (const auto& worker : m_loopPool->loops()) {
+        presenceReaders.emplace_back(worker.get(), m_sessionManager->presence()->registerReader());
+    }
 
-    // 2. 创建 SessionManager
-    m_sessionManager = std::make_shared<SessionManager>();
+    m_context = std::make_shared<ServerContext>();
+    m_context->sessionManager = m_sessionManager;
+    m_context->router = m_router;
+    m_context->wsHandler = m_wsHandler;
+    m_context->rooms = m_rooms;
 
-    // 3. 创建 Acceptor
-    m_acceptor = std::make_shared<Acceptor>(m_loop, port, m_sessionManager);
+    // 登录票据：由认证服务用同一 secret 签发，没配置时不接受 /login
+    std::string loginSecret = Config::getString("session.login_secret", "");
+    if (!loginSecret.empty()) {
+        m_context->loginTickets = std::make_shared<const SessionToken>(loginSecret, "login");
+    }
 
-    // 4. 启动监听
-    m_acceptor->startAccept();
-    LOG_INFO("Server started at port {}", port);
+    // 离线消息日志：不在线用户的私信先写本地 mmap 日志，重连时整批取出
+    if (Config::getBool("offline_log.enabled", true)) {
+        OfflineLog::Options offline;
+        offline.dir = Config::getString("offline_log.dir", "offline");
+        offline.shards = std::max(1, Config::getInt("offline_log.shards", 16));
+        offline.segmentBytes = Config::getInt("offline_log.segment_bytes", 16 * 1024 * 1024);
+        offline.flushIntervalMs = std::max(1, Config::getInt("offline_log.flush_interval_ms", 200));
+        offline.compactLiveRatio = Config::getInt("offline_log.compact_live_percent", 25) / 100.0;
+        offline.maxMessagesPerUser = Config::getInt("offline_log.max_messages_per_user", 1000);
+        m_offlineLog = std::make_shared<OfflineLog>(offline);
+        m_context->offlineLog = m_offlineLog;
+    }
 
-    // 5. 启动 IO 循环（阻塞调用）
-    //    如果想非阻塞，可换成 std::thread 启动
+    // 聊天消息持久化：loop 线程只入队，写线程按批组提交到 MySQL（表结构见 RoomMessageHandler）
+    if (Config::getBool("persistence.enabled", false)) {
+        WriteBehind::Options persist;
+        persist.table = Config::getString("persistence.table", "messages");
+        persist.columns = {"channel", "sender", "content", "created_ms"};
+        persist.writers = std::max(1, Config::getInt("persistence.writers", 2));
+        persist.batchRows = std::max(1, Config::getInt("persistence.batch_rows", 256));
+        persist.flushIntervalMs = std::max(1, Config::getInt("persistence.flush_interval_ms", 20));
+        persist.queueCapacity = std::max(2, Config::getInt("persistence.queue_capacity", 65536));
+        persist.maxRetries = std::max(0, Config::getInt("persistence.max_retries", 3));
+        m_messageWriter = std::make_shared<WriteBehind>(MysqlPool::getConnectPool(), persist);
+        m_context->messageWriter = m_messageWriter;
+    }
+
+    // 房间最近消息缓存：加入房间时从内存发出；启用持久化时冷房间从同一张表回填
+    size_t historyCapacity = std::max(0, Config::getInt("room_history.capacity", 50));
+    if (historyCapacity > 0) {
+        RoomHistory::Options history;
+        history.capacity = historyCapacity;
+        history.maxRooms = std::max(1, Config::getInt("room_history.max_rooms", 10000));
+        RoomHistory::Loader loader;
+        if (m_messageWriter) {
+            loader = RoomHistory::mysqlLoader(MysqlPool::getConnectPool(),
+                                              Config::getString("persistence.table", "messages"));
+        }
+        m_rooms->setHistory(std::make_shared<RoomHistory>(history, std::move(loader)));
+    }
+
+    // 5. 创建 Acceptor
+    //    reuse_port=false: 单个 Acceptor 在 accept loop 上监听，再把连接分给 worker
+    //    reuse_port=true : 每个 worker loop 各自持有一个 SO_REUSEPORT 监听 socket，
+    //                      由内核把新连接分散到各个核上
+    bool reusePort = Config::getBool("server.reuse_port", false);
+    if (reusePort) {
+        for (const auto& loop : m_loopPool->loops()) {
+            m_acceptors.push_back(
+                std::make_shared<Acceptor>(loop, port, m_context, nullptr, true));
+        }
+    } else {
+        m_acceptors.push_back(
+            std::make_shared<Acceptor>(m_loop, port, m_context, m_loopPool));
+    }
+
+    // 6. 启动监听
+    for (auto& acceptor : m_acceptors) {
+        acceptor->startAccept();
+    }
+    LOG_INFO("Server started at port {}, io_threads={}, acceptors={}",
+             port, ioThreads, m_acceptors.size());
+
+    // 7. 启动 IO 循环（各自在独立线程中运行）
+    m_loopPool->start();
     m_loop->run();
+
+    // 8. accept loop 上的周期任务（时间轮只能在 loop 线程操作，先 post 过去）
+    EventLoop* loop = m_loop.get();
+    std::weak_ptr<EventLoopPool> pool = m_loopPool;
+    std::weak_ptr<SessionManager> sessions = m_sessionManager;
+
+    // 延迟统计定期输出到日志，0 表示关闭
+    int statsIntervalMs = Config::getInt("server.stats_log_interval_ms", 60000);
+    if (statsIntervalMs > 0) {
+        m_loop->post([loop, pool, statsIntervalMs] {
+            runEvery(loop, static_cast<uint64_t>(statsIntervalMs), [loop, pool] {
+                auto workers = pool.lock();
+                if (!workers) return false;
+
+                LOG_INFO("accept loop stats: {}", LoopStats::format(loop->stats().snapshot()));
+                for (const auto& worker : workers->loops()) {
+                    LOG_INFO("loop {} stats: connections={}, {}", worker->index(),
+                             worker->connectionCount(), LoopStats::format(worker->stats().snapshot()));
+                }
+                return true;
+            });
+        });
+    }
+
+    // 过期 Session 增量回收：每次只检查 session.sweep_batch 个条目，不会卡住 loop
+    uint64_t sweepMs = static_cast<uint64_t>(std::max(1, Config::getInt("session.sweep_interval_ms", 100)));
+    m_loop->post([loop, sessions, sweepMs] {
+        runEvery(loop, sweepMs, [sessions] {
+            auto manager = sessions.lock();
+            if (!manager) return false;
+            manager->sweepExpired();
+            return true;
+        });
+    });
+
+    // 在线索引的静止点：每个 loop 每个 tick 报告一次，旧节点最多延迟一个 tick 释放
+    std::weak_ptr<PresenceIndex> presence = m_sessionManager->presence();
+    for (const auto& [reader, slot] : presenceReaders) {
+        reader->post([reader = reader, slot = slot, presence, tickMs] {
+            runEvery(reader, tickMs, [presence, slot] {
+                auto index = presence.lock();
+                if (!index) return false;
+                index->quiescent(slot);
+                return true;
+            });
+        });
+    }
 }
 
 void NetBootstrap::stop() {
     LOG_INFO("Stopping server...");
 
     // 1. 停止 Acceptor
-    if (m_acceptor) {
-        m_acceptor->stop();
-        m_acceptor.reset();
+    for (auto& acceptor : m_acceptors) {
+        acceptor->stop();
     }
+    m_acceptors.clear();
+
+    m_context.reset();
+    m_offlineLog.reset();       // 最后一个持有者释放时刷盘并关闭
+    m_messageWriter.reset();    // 写完队列中剩余的消息后退出
 
-    // 2. 关闭所有 Session（并通过 Session detach 所有连接）
+    // 2. 写出 Session 快照，再关闭所有 Session（并通过 Session detach 所有连接）
     if (m_sessionManager) {
+        if (!m_snapshotPath.empty()) {
+            m_sessionManager->saveSnapshot(m_snapshotPath);
+        }
         m_sessionManager->removeAllSessions();
         m_sessionManager.reset();
     }
@@ -49,5 +246,26 @@ void NetBootstrap::stop() {
         m_loop.reset();
     }
 
+    if (m_loopPool) {
+        m_loopPool->stop();
+        m_loopPool.reset();
+    }
+
     LOG_INFO("Server stopped");
 }
+
+std::shared_ptr<EventLoopPool> NetBootstrap::loopPool() const {
+    return m_loopPool;
+}
+
+std::shared_ptr<HttpRouter> NetBootstrap::router() const {
+    return m_router;
+}
+
+std::shared_ptr<RoomManager> NetBootstrap::rooms() const {
+    return m_rooms;
+}
+
+void NetBootstrap::setMessageHandler(std::shared_ptr<WsMessageHandler> handler) {
+    m_wsHandler = std::move(handler);
+}
@@ -3,10 +3,19 @@
 
 #include <memory>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "EventLoop.h"
+#include "EventLoopPool.h"
 #include "Acceptor.h"
 #include "SessionManager.h"
+#include "ServerContext.h"
+#include "HttpRouter.h"
+#include "RoomManager.h"
+#include "OfflineLog.h"
+#include "WriteBehind.h"
+#include "MysqlPool.h"
 
 class NetBootstrap {
 public:
@@ -19,8 +28,28 @@ public:
     // 停止服务器，关闭所有连接和 Session
     void stop();
 
+    // HTTP 路由表，需在 start() 之前注册路由
+    std::shared_ptr<HttpRouter> router() const;
+
+    // WebSocket 消息处理，需在 start() 之前设置；默认回显
+    void setMessageHandler(std::shared_ptr<WsMessageHandler> handler);
+
+    // 房间注册表，供消息处理器加入/离开/广播
+    std::shared_ptr<RoomManager> rooms() const;
+
+    // worker loop 池（可用于查询每个 loop 的连接数）
+    std::shared_ptr<EventLoopPool> loopPool() const;
+
 private:
-    std::shared_ptr<EventLoop> m_loop;
+    std::shared_ptr<EventLoop> m_loop;          // accept loop
+    std::shared_ptr<EventLoopPool> m_loopPool;  // worker loops
     std::shared_ptr<SessionManager> m_sessionManager;
-    std::shared_ptr<Acceptor> m_acceptor;
+    std::shared_ptr<HttpRouter> m_router;
+    std::shared_ptr<WsMessageHandler> m_wsHandler;
+    std::shared_ptr<RoomManager> m_rooms;
+    std::shared_ptr<OfflineLog> m_offlineLog;
+    std::shared_ptr<WriteBehind> m_messageWriter;
+    std::shared_ptr<ServerContext> m_context;
+    std::vector<std::shared_ptr<Acceptor>> m_acceptors;
+    std::string m_snapshotPath;                 // 为空时不做热重启快照
 };
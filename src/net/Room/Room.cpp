@@ -0,0 +1,177 @@
+#include "Room.h"
+#include "Logger.h"
+
+Room::Room(std::string name) : m_name(std::move(name)) {
+    m_snapshot.store(std::make_shared<const Snapshot>());
+}
+
+const std::string& Room::name() const {
+    return m_name;
+}
+
+bool Room::join(const Connection::Ptr& conn) {
+    if (!conn) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Group& group = m_groups[conn->loop().get()];
+    auto [it, inserted] = group.index.emplace(conn.get(), group.members.size());
+    if (!inserted) {
+        // 地址被一个已销毁、还没清理掉的连接占着时，换成新连接
+        std::weak_ptr<Connection>& existing = group.members[it->second];
+        if (!existing.expired()) {
+            return false;
+        }
+        existing = conn;
+        group.dirty = true;
+        m_dirty.store(true, std::memory_order_release);
+        return true;
+    }
+    group.loop = conn->loop();
+    group.members.push_back(conn);
+    group.keys.push_back(conn.get());
+    group.dirty = true;
+    m_size.fetch_add(1, std::memory_order_relaxed);
+    m_dirty.store(true, std::memory_order_release);
+    return true;
+}
+
+bool Room::leave(const Connection* conn) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return removeLocked(conn);
+}
+
+bool Room::removeLocked(const Connection* conn) {
+    for (auto& [loop, group] : m_groups) {
+        auto it = group.index.find(conn);
+        if (it == group.index.end()) {
+            continue;
+        }
+
+        // 换尾删除，顺带修正被换过来的那个连接的下标
+        size_t pos = it->second;
+        group.index.erase(it);
+        if (pos + 1 != group.members.size()) {
+            group.members[pos] = std::move(group.members.back());
+            group.keys[pos] = group.keys.back();
+            group.index[group.keys[pos]] = pos;
+        }
+        group.members.pop_back();
+        group.keys.pop_back();
+        group.dirty = true;
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        m_dirty.store(true, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+size_t Room::size() const {
+    return m_size.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const Room::Snapshot> Room::snapshot() {
+    if (m_dirty.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_dirty.load(std::memory_order_relaxed)) {
+            rebuildLocked();
+        }
+    }
+    return std::static_pointer_cast<const Snapshot>(m_snapshot.load());
+}
+
+void Room::rebuildLocked() {
+    auto snap = std::make_shared<Snapshot>();
+    snap->reserve(m_groups.size());
+
+    for (auto it = m_groups.begin(); it != m_groups.end();) {
+        Group& group = it->second;
+        if (group.members.empty()) {
+            it = m_groups.erase(it);
+            continue;
+        }
+        // 🔑 只复制变过的分组，其它 loop 的快照原样复用
+        if (group.dirty || !group.published) {
+            group.published = std::make_shared<const LoopGroup>(LoopGroup{group.loop, group.members});
+            group.dirty = false;
+        }
+        snap->push_back(group.published);
+        ++it;
+    }
+
+    m_snapshot.store(std::move(snap));
+    m_dirty.store(false, std::memory_order_release);
+}
+
+size_t Room::publish(const MessageBuffer::Ptr& msg) {
+    auto snap = snapshot();
+
+    size_t recipients = 0;
+    std::shared_ptr<const LoopGroup> local;
+    for (const auto& group : *snap) {
+        recipients += group->members.size();
+        if (group->loop->isInLoopThread()) {
+            local = group;
+            continue;
+        }
+        // 每个 loop 一个任务，任务持有分组快照和消息，不依赖 Room 的成员表后续变化
+        group->loop->post([self = shared_from_this(), group, msg] {
+            self->deliver(*group, msg);
+        });
+    }
+
+    // 其它 loop 的任务先发出去，再处理本 loop 的订阅者
+    if (local) {
+        deliver(*local, msg);
+    }
+    return recipients;
+}
+
+void Room::deliver(const LoopGroup& group, const MessageBuffer::Ptr& msg) {
+    bool stale = false;
+    for (const auto& weak : group.members) {
+        if (auto conn = weak.lock()) {
+            conn->send(msg);
+        } else {
+            stale = true;
+        }
+    }
+
+    // 没有正常 leave 就销毁的连接：在这里顺手清掉
+    if (stale) {
+        prune(group.loop.get());
+    }
+}
+
+void Room::prune(const EventLoop* loop) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_groups.find(loop);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    Group& group = it->second;
+    size_t before = group.members.size();
+    size_t kept = 0;
+    for (size_t i = 0; i < before; ++i) {
+        if (group.members[i].expired()) {
+            group.index.erase(group.keys[i]);
+            continue;
+        }
+        if (kept != i) {
+            group.members[kept] = std::move(group.members[i]);
+            group.keys[kept] = group.keys[i];
+            group.index[group.keys[kept]] = kept;
+        }
+        ++kept;
+    }
+    group.members.resize(kept);
+    group.keys.resize(kept);
+
+    size_t removed = before - group.members.size();
+    if (removed > 0) {
+        group.dirty = true;
+        m_size.fetch_sub(removed, std::memory_order_relaxed);
+        m_dirty.store(true, std::memory_order_release);
+        LOG_DEBUG("Pruned {} stale members, room={}", removed, m_name);
+    }
+}
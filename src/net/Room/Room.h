@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Connection.h"
+#include "EventLoop.h"
+#include "MessageBuffer.h"
+#include "SessionSlots.h"
+
+// 一个房间（主题）的订阅者，按连接所属的 EventLoop 分组。
+// - 发布：读无锁的成员快照，每个 loop 只投递一个任务，任务里给该 loop 上的所有订阅者 send，
+//   跨线程开销按 loop 数而不是按接收者数付出；本线程所在 loop 的那组直接就地发送
+// - 加入/离开：在锁内改主表并把所在分组标脏，不复制整个成员表；
+//   下一次发布时才为脏分组重建快照（写时复制），大量同时加入时不会反复拷贝
+class Room : public std::enable_shared_from_this<Room> {
+public:
+    using Ptr = std::shared_ptr<Room>;
+
+    // 某个 loop 上的订阅者快照，发布后由投递任务持有，构建后不再修改
+    struct LoopGroup {
+        std::shared_ptr<EventLoop> loop;
+        std::vector<std::weak_ptr<Connection>> members;
+    };
+    using Snapshot = std::vector<std::shared_ptr<const LoopGroup>>;
+
+    explicit Room(std::string name);
+
+    const std::string& name() const;
+
+    // 返回 false 表示已在房间中 / 不在房间中
+    bool join(const Connection::Ptr& conn);
+    bool leave(const Connection* conn);
+    size_t size() const;
+
+    // 投递给所有订阅者，返回接收者数量（发布时刻的快照）
+    size_t publish(const MessageBuffer::Ptr& msg);
+
+private:
+    struct Group {
+        std::shared_ptr<EventLoop> loop;
+        std::vector<std::weak_ptr<Connection>> members;
+        std::vector<const Connection*> keys;                    // 与 members 一一对应
+        std::unordered_map<const Connection*, size_t> index;   // 连接 -> 下标，离开时 O(1) 换尾删除
+        std::shared_ptr<const LoopGroup> published;             // 上次发布用的快照
+        bool dirty = true;
+    };
+
+    std::shared_ptr<const Snapshot> snapshot();
+    void rebuildLocked();
+    bool removeLocked(const Connection* conn);
+    void prune(const EventLoop* loop);
+
+    void deliver(const LoopGroup& group, const MessageBuffer::Ptr& msg);
+
+    const std::string m_name;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<const EventLoop*, Group> m_groups;
+    std::atomic<size_t> m_size{0};
+    std::atomic<bool> m_dirty{false};
+    AtomicSharedPtr m_snapshot;             // shared_ptr<const Snapshot>
+};
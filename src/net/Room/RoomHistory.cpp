@@ -0,0 +1,195 @@
+#include "RoomHistory.h"
+#include "MysqlPool.h"
+#include "Thread_pool.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+int64_t wallMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+}
+
+RoomHistory::RoomHistory(Options options, Loader loader)
+    : m_options(options), m_loader(std::move(loader)) {
+}
+
+MessageBuffer::Ptr RoomHistory::frame(std::string_view room, std::string_view text) {
+    std::string payload;
+    payload.reserve(room.size() + text.size() + 3);
+    payload.append("[").append(room).append("] ").append(text);
+    return MessageBuffer::make(std::move(payload));
+}
+
+std::string RoomHistory::channelOf(std::string_view room) {
+    std::string channel("room:");
+    channel.append(room);
+    return channel;
+}
+
+RoomHistory::Loader RoomHistory::mysqlLoader(MysqlPool* pool, std::string table) {
+    return [pool, table = std::move(table)](const std::string& room, size_t limit, int64_t beforeMs) {
+        std::vector<std::string> rows;
+        auto conn = pool ? pool->getConn() : nullptr;
+        if (!conn) {
+            return rows;
+        }
+
+        // 预处理语句按连接缓存，每个房间第一次回填只绑定参数，不再拼接和解析 SQL
+        MysqlStmt* stmt = conn->prepare("SELECT content FROM " + table +
+                                        " WHERE channel=? AND created_ms<? ORDER BY id DESC LIMIT ?");
+        if (stmt == nullptr) {
+            return rows;
+        }
+        stmt->bindString(0, channelOf(room));
+        stmt->bindInt(1, beforeMs);
+        stmt->bindUInt(2, limit);
+        if (!stmt->execute()) {
+            LOG_WARN("Room history query failed, room={}", room);
+            return rows;
+        }
+        while (stmt->next()) {
+            rows.emplace_back(stmt->getView(0));
+        }
+        std::reverse(rows.begin(), rows.end());
+        return rows;
+    };
+}
+
+void RoomHistory::Ring::push(MessageBuffer::Ptr frame) {
+    slots[head] = std::move(frame);
+    head = (head + 1) % slots.size();
+    count = std::min(count + 1, slots.size());
+}
+
+RoomHistory::Frames RoomHistory::Ring::framesLocked() const {
+    Frames frames;
+    frames.reserve(count);
+    size_t start = (head + slots.size() - count) % slots.size();
+    for (size_t i = 0; i < count; ++i) {
+        frames.push_back(slots[(start + i) % slots.size()]);
+    }
+    return frames;
+}
+
+std::shared_ptr<RoomHistory::Ring> RoomHistory::ring(const std::string& room) {
+    std::shared_ptr<Ring> r;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_rings.find(room);
+        if (it != m_rings.end()) {
+            r = it->second;
+        }
+    }
+
+    if (!r) {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        std::shared_ptr<Ring>& slot = m_rings[room];
+        if (!slot) {
+            if (m_rings.size() > m_options.maxRooms) {
+                evictLocked();
+            }
+            slot = std::make_shared<Ring>();
+            slot->slots.resize(std::max<size_t>(m_options.capacity, 1));
+            slot->createdMs = wallMs();
+            slot->state = m_loader ? State::Cold : State::Warm;
+        }
+        r = slot;
+    }
+
+    r->lastUsed.store(m_clock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+    return r;
+}
+
+void RoomHistory::evictLocked() {
+    // 新房间才会走到这里，全表扫一遍找最久没用的即可；正在回填的环不淘汰
+    auto victim = m_rings.end();
+    uint64_t oldest = UINT64_MAX;
+    for (auto it = m_rings.begin(); it != m_rings.end(); ++it) {
+        if (!it->second) continue;
+        uint64_t used = it->second->lastUsed.load(std::memory_order_relaxed);
+        if (used < oldest) {
+            std::lock_guard<std::mutex> lock(it->second->mutex);
+            if (it->second->state == State::Loading) continue;
+            oldest = used;
+            victim = it;
+        }
+    }
+    if (victim != m_rings.end()) {
+        LOG_DEBUG("Room history evicted, room={}", victim->first);
+        m_rings.erase(victim);
+    }
+}
+
+void RoomHistory::append(const std::string& room, MessageBuffer::Ptr frame) {
+    if (!frame) return;
+    auto r = ring(room);
+    std::lock_guard<std::mutex> lock(r->mutex);
+    r->push(std::move(frame));
+}
+
+void RoomHistory::fetch(const std::string& room, FetchCallback done) {
+    auto r = ring(room);
+
+    Frames frames;
+    {
+        std::lock_guard<std::mutex> lock(r->mutex);
+        if (r->state != State::Warm) {
+            bool cold = r->state == State::Cold;
+            r->state = State::Loading;
+            r->waiters.push_back(std::move(done));
+            if (cold) {
+                backfill(room, r);
+            }
+            return;
+        }
+        frames = r->framesLocked();
+    }
+
+    if (done) done(std::move(frames));
+}
+
+size_t RoomHistory::roomCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_rings.size();
+}
+
+void RoomHistory::backfill(const std::string& room, const std::shared_ptr<Ring>& ring) {
+    // 🔑 任务只持有 loader 副本和环本身，不依赖 RoomHistory 的生命周期
+    ThreadPool::detach_task([loader = m_loader, room, ring, limit = ring->slots.size()] {
+        std::vector<std::string> rows;
+        try {
+            rows = loader(room, limit, ring->createdMs);
+        } catch (const std::exception& e) {
+            LOG_WARN("Room history backfill failed, room={}, error={}", room, e.what());
+        }
+
+        Frames frames;
+        std::vector<FetchCallback> waiters;
+        {
+            std::lock_guard<std::mutex> lock(ring->mutex);
+            // 库里的行都早于环里已有的消息：先放库里的，再把环里的接在后面
+            Frames recent = ring->framesLocked();
+            std::fill(ring->slots.begin(), ring->slots.end(), nullptr);
+            ring->head = 0;
+            ring->count = 0;
+            for (const auto& row : rows) {
+                ring->push(frame(room, row));
+            }
+            for (auto& f : recent) {
+                ring->push(std::move(f));
+            }
+            // 查询失败也转为热：只用内存里的消息，不在每次加入时反复打库
+            ring->state = State::Warm;
+            frames = ring->framesLocked();
+            waiters.swap(ring->waiters);
+        }
+
+        LOG_DEBUG("Room history backfilled, room={}, rows={}, waiters={}", room, rows.size(), waiters.size());
+        for (auto& waiter : waiters) {
+            if (waiter) waiter(frames);
+        }
+    });
+}
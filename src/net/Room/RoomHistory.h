@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MessageBuffer.h"
+
+class MysqlPool;
+
+// 每个房间最近 N 条消息的定长环形缓冲，存的是已经编码好的 "[room] text" 帧（MessageBuffer），
+// 加入房间时直接把这些帧整批发出去，不查库、不重新拼字符串。
+// - 发布路径（RoomManager::publish）顺手 append，环一直是热的
+// - 环第一次被用到时（冷）用 Loader 在 ThreadPool 上回填一次库里更早的消息，
+//   只取创建时刻之前写入的行，之后发布的消息已经在环里，不会重复
+// - 回填期间到来的 fetch 挂起，回填完成后一起回调
+// - 环的数量有上限，超出时淘汰最久没用过的
+// 注意：写后管道还没落库的消息（flush 间隔内）不会出现在回填结果里。
+class RoomHistory {
+public:
+    using Frames = std::vector<MessageBuffer::Ptr>;
+    using FetchCallback = std::function<void(Frames)>;
+    // 返回 channel 在 beforeMs（墙钟毫秒）之前的最近 limit 条原文，从旧到新
+    using Loader = std::function<std::vector<std::string>(const std::string& room, size_t limit, int64_t beforeMs)>;
+
+    struct Options {
+        size_t capacity = 50;       // 每个房间保留多少条
+        size_t maxRooms = 10000;    // 最多缓存多少个房间
+    };
+
+    explicit RoomHistory(Options options, Loader loader = nullptr);
+
+    // 房间消息的编码方式，发布和回填共用，保证两条路径出来的帧一致
+    static MessageBuffer::Ptr frame(std::string_view room, std::string_view text);
+    // 持久化时房间消息所在的 channel
+    static std::string channelOf(std::string_view room);
+    // 从 MessagesTable（见 RoomMessageHandler.h）按 channel 回填
+    static Loader mysqlLoader(MysqlPool* pool, std::string table);
+
+    void append(const std::string& room, MessageBuffer::Ptr frame);
+
+    // 取最近的消息（从旧到新）。环是热的时在当前线程同步回调；
+    // 冷的时回填完成后在 ThreadPool 线程上回调
+    void fetch(const std::string& room, FetchCallback done);
+
+    size_t roomCount() const;
+
+private:
+    enum class State { Cold, Loading, Warm };
+
+    struct Ring {
+        std::mutex mutex;
+        std::vector<MessageBuffer::Ptr> slots;  // 定长，capacity 个
+        size_t head = 0;                        // 下一个写入位置
+        size_t count = 0;
+        State state = State::Cold;
+        int64_t createdMs = 0;                  // 回填只取这之前的行
+        std::vector<FetchCallback> waiters;
+        std::atomic<uint64_t> lastUsed{0};
+
+        void push(MessageBuffer::Ptr frame);
+        Frames framesLocked() const;
+    };
+
+    std::shared_ptr<Ring> ring(const std::string& room);
+    void evictLocked();
+    void backfill(const std::string& room, const std::shared_ptr<Ring>& ring);
+
+    const Options m_options;
+    const Loader m_loader;
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Ring>> m_rings;
+    std::atomic<uint64_t> m_clock{0};
+};
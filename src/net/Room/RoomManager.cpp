@@ -0,0 +1,136 @@
+#include "RoomManager.h"
+#include "Logger.h"
+#include <algorithm>
+#include <mutex>
+
+RoomManager::RoomManager()
+    : m_roomsSlot(SessionSlots::object<RoomList>("rooms")) {
+}
+
+bool RoomManager::join(const std::string& name, const Connection::Ptr& conn) {
+    if (!conn) return false;
+
+    bool joined;
+    {
+        // 加入/离开与房间的创建/删除一起串行化，避免加入一个刚被删掉的房间
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        Room::Ptr& room = m_rooms[name];
+        if (!room) {
+            room = std::make_shared<Room>(name);
+            LOG_INFO("Room created, name={}", name);
+        }
+        joined = room->join(conn);
+    }
+
+    updateSessionRooms(conn, name, true);
+    LOG_DEBUG("join room, name={}, conn={}, joined={}", name, static_cast<const void*>(conn.get()), joined);
+    return joined;
+}
+
+bool RoomManager::leave(const std::string& name, const Connection::Ptr& conn) {
+    if (!conn) return false;
+
+    bool left = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_rooms.find(name);
+        if (it != m_rooms.end()) {
+            left = it->second->leave(conn.get());
+            if (it->second->size() == 0) {
+                m_rooms.erase(it);
+                LOG_INFO("Room removed, name={}", name);
+            }
+        }
+    }
+
+    updateSessionRooms(conn, name, false);
+    return left;
+}
+
+void RoomManager::restore(const Connection::Ptr& conn) {
+    auto session = conn ? conn->getSession() : nullptr;
+    if (!session) return;
+
+    auto rooms = session->get(m_roomsSlot);
+    if (!rooms || rooms->empty()) return;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const auto& name : *rooms) {
+        Room::Ptr& room = m_rooms[name];
+        if (!room) {
+            room = std::make_shared<Room>(name);
+            LOG_INFO("Room created, name={}", name);
+        }
+        room->join(conn);
+    }
+    LOG_DEBUG("Rooms restored, sid={}, rooms={}", session->id(), rooms->size());
+}
+
+void RoomManager::detach(const Connection::Ptr& conn) {
+    auto session = conn ? conn->getSession() : nullptr;
+    if (!session) return;
+
+    auto rooms = session->get(m_roomsSlot);
+    if (!rooms || rooms->empty()) return;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (const auto& name : *rooms) {
+        auto it = m_rooms.find(name);
+        if (it == m_rooms.end()) continue;
+        it->second->leave(conn.get());
+        if (it->second->size() == 0) {
+            m_rooms.erase(it);
+            LOG_INFO("Room removed, name={}", name);
+        }
+    }
+}
+
+size_t RoomManager::publish(const std::string& name, const MessageBuffer::Ptr& msg) {
+    if (m_history) {
+        m_history->append(name, msg);
+    }
+    Room::Ptr room = find(name);
+    return room ? room->publish(msg) : 0;
+}
+
+void RoomManager::setHistory(std::shared_ptr<RoomHistory> history) {
+    m_history = std::move(history);
+}
+
+const std::shared_ptr<RoomHistory>& RoomManager::history() const {
+    return m_history;
+}
+
+Room::Ptr RoomManager::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_rooms.find(name);
+    return it != m_rooms.end() ? it->second : nullptr;
+}
+
+size_t RoomManager::roomCount() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_rooms.size();
+}
+
+std::shared_ptr<const RoomManager::RoomList> RoomManager::roomsOf(const Session& session) const {
+    return session.get(m_roomsSlot);
+}
+
+void RoomManager::updateSessionRooms(const Connection::Ptr& conn, const std::string& name, bool add) {
+    auto session = conn->getSession();
+    if (!session) return;
+
+    // 房间列表是不可变对象，改动时整体替换；同一 Session 的并发改动极少，读改写即可
+    auto current = session->get(m_roomsSlot);
+    bool present = current && std::find(current->begin(), current->end(), name) != current->end();
+    if (present == add) return;
+
+    auto next = std::make_shared<RoomList>();
+    if (current) *next = *current;
+    if (add) {
+        next->push_back(name);
+    } else {
+        next->erase(std::remove(next->begin(), next->end(), name), next->end());
+    }
+    session->set(m_roomsSlot, std::shared_ptr<const RoomList>(std::move(next)));
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Room.h"
+#include "RoomHistory.h"
+#include "Session.h"
+
+// 进程内的房间（主题）注册表。
+// 成员以 Connection 为单位投递，但"加入了哪些房间"记在 Session 上（对象槽），
+// 同一 Session 的新连接（断线重连、多端登录）通过 restore 自动回到原来的房间。
+// 房间在第一个成员加入时创建，最后一个成员离开时删除。
+// 所有方法线程安全；publish 只拿注册表的共享锁，成员快照本身无锁。
+class RoomManager {
+public:
+    using RoomList = std::vector<std::string>;
+
+    RoomManager();
+
+    // 连接加入 / 离开房间，同时更新其 Session 的房间列表
+    bool join(const std::string& name, const Connection::Ptr& conn);
+    bool leave(const std::string& name, const Connection::Ptr& conn);
+
+    // 新连接绑定 Session 后调用：重新加入 Session 记录的所有房间
+    void restore(const Connection::Ptr& conn);
+    // 连接关闭时调用：从所有房间摘下该连接，Session 的房间列表保留（供重连恢复）
+    void detach(const Connection::Ptr& conn);
+
+    // 返回接收者数量；房间不存在时为 0。启用了历史时消息同时记入该房间的历史环
+    size_t publish(const std::string& name, const MessageBuffer::Ptr& msg);
+
+    // 最近消息缓存，在开始服务之前设置；未设置时为空
+    void setHistory(std::shared_ptr<RoomHistory> history);
+    const std::shared_ptr<RoomHistory>& history() const;
+
+    Room::Ptr find(const std::string& name) const;
+    size_t roomCount() const;
+
+    // 某个 Session 当前所在的房间
+    std::shared_ptr<const RoomList> roomsOf(const Session& session) const;
+
+private:
+    void updateSessionRooms(const Connection::Ptr& conn, const std::string& name, bool add);
+
+    ObjectSlot<RoomList> m_roomsSlot;
+    std::shared_ptr<RoomHistory> m_history;
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, Room::Ptr> m_rooms;
+};
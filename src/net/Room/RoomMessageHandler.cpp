@@ -0,0 +1,174 @@
+#include "RoomMessageHandler.h"
+#include "WebSocketConnection.h"
+#include "SessionManager.h"
+#include "SessionToken.h"
+#include "OfflineLog.h"
+#include "WriteBehind.h"
+#include "Logger.h"
+#include <charconv>
+#include <chrono>
+
+namespace {
+// 从 s 中切出第一个以空格分隔的词，s 前移到剩余部分
+std::string_view nextWord(std::string_view& s) {
+    size_t begin = s.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        s = {};
+        return {};
+    }
+    s.remove_prefix(begin);
+    size_t end = std::min(s.find(' '), s.size());
+    std::string_view word = s.substr(0, end);
+    s.remove_prefix(end);
+    if (!s.empty()) s.remove_prefix(1);
+    return word;
+}
+
+// 当前 loop 的完成回调投递器：每个 loop 线程只建一个，写后管道按它合并同一 loop 的回调
+const WriteBehind::ExecutorPtr& loopExecutor(const std::shared_ptr<EventLoop>& loop) {
+    thread_local WriteBehind::ExecutorPtr executor;
+    thread_local const EventLoop* owner = nullptr;
+    if (owner != loop.get()) {
+        std::weak_ptr<EventLoop> weak = loop;
+        executor = std::make_shared<const WriteBehind::Executor>([weak](std::function<void()> fn) {
+            if (auto l = weak.lock()) l->post(std::move(fn));
+        });
+        owner = loop.get();
+    }
+    return executor;
+}
+}
+
+RoomMessageHandler::RoomMessageHandler(std::shared_ptr<RoomManager> rooms)
+    : m_rooms(std::move(rooms)) {
+}
+
+void RoomMessageHandler::onOpen(WebSocketConnection& conn) {
+    m_rooms->restore(conn.shared_from_this());
+}
+
+void RoomMessageHandler::onText(WebSocketConnection& conn, std::string_view payload) {
+    std::string_view rest = payload;
+    std::string_view command = nextWord(rest);
+    std::string_view arg = nextWord(rest);
+
+    if (command == "/login" || command == "/dm") {
+        onUserCommand(conn, command, arg, rest);
+        return;
+    }
+
+    std::string_view room = arg;
+    if (command == "/join" && !room.empty()) {
+        m_rooms->join(std::string(room), conn.shared_from_this());
+        conn.send(MessageBuffer::make("joined " + std::string(room)));
+        // 🔑 最近消息直接取内存里编码好的帧整批发出；冷房间回填完成后再发
+        if (const auto& history = m_rooms->history()) {
+            std::weak_ptr<Connection> weak = conn.shared_from_this();
+            history->fetch(std::string(room), [weak](RoomHistory::Frames frames) {
+                if (auto c = weak.lock()) c->sendBatch(std::move(frames));
+            });
+        }
+        return;
+    }
+
+    if (command == "/leave" && !room.empty()) {
+        m_rooms->leave(std::string(room), conn.shared_from_this());
+        conn.send(MessageBuffer::make("left " + std::string(room)));
+        return;
+    }
+
+    if (command == "/say" && !room.empty()) {
+        // 🔑 只序列化一次，所有接收方和历史环共享同一个 MessageBuffer
+        size_t recipients = m_rooms->publish(std::string(room), RoomHistory::frame(room, rest));
+        LOG_DEBUG("publish, room={}, recipients={}", room, recipients);
+        persist(conn, RoomHistory::channelOf(room), rest);
+        return;
+    }
+
+    std::string reply;
+    reply.reserve(6 + payload.size());
+    reply.append("Echo: ").append(payload);
+    conn.send(MessageBuffer::make(std::move(reply)));
+}
+
+void RoomMessageHandler::onUserCommand(WebSocketConnection& conn, std::string_view command,
+                                       std::string_view user, std::string_view text) {
+    uint64_t userId = 0;
+    auto [end, ec] = std::from_chars(user.data(), user.data() + user.size(), userId);
+    if (ec != std::errc() || end != user.data() + user.size() || userId == 0) {
+        conn.send(MessageBuffer::make("bad user id"));
+        return;
+    }
+
+    const auto& context = conn.context();
+    auto session = conn.getSession();
+    if (!context || !context->sessionManager || !session) {
+        return;
+    }
+    PresenceIndex& presence = *context->sessionManager->presence();
+
+    if (command == "/login") {
+        // 🔑 只认认证服务签发的票据：票据里的 id 必须就是要登录的用户，且未过期
+        std::string_view ticket = nextWord(text);
+        uint64_t nowSec = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        auto verified = context->loginTickets ? context->loginTickets->verify(ticket, nowSec) : std::nullopt;
+        if (!verified || *verified != userId) {
+            LOG_WARN("Login rejected, uid={}, conn={}", userId, static_cast<void*>(&conn));
+            conn.send(MessageBuffer::make("login failed"));
+            return;
+        }
+        presence.login(*session, userId);
+        conn.send(MessageBuffer::make("logged in " + std::to_string(userId)));
+        conn.deliverOffline();
+        return;
+    }
+
+    persist(conn, "user:" + std::to_string(userId), text);
+
+    std::string message;
+    message.reserve(text.size() + 8);
+    message.append("[dm] ").append(text);
+
+    // 🔑 在线就直接投递到该用户的所有连接，否则写离线日志，重连时整批取出
+    auto msg = MessageBuffer::make(std::move(message));
+    if (presence.sendToUser(userId, msg) > 0) {
+        return;
+    }
+    if (context->offlineLog && context->offlineLog->append(userId, msg->payload())) {
+        conn.send(MessageBuffer::make("queued offline for " + std::to_string(userId)));
+        return;
+    }
+    conn.send(MessageBuffer::make("user offline " + std::to_string(userId)));
+}
+
+void RoomMessageHandler::persist(WebSocketConnection& conn, std::string channel, std::string_view text) {
+    const auto& context = conn.context();
+    if (!context || !context->messageWriter) {
+        return;
+    }
+
+    uint64_t sender = 0;
+    if (auto session = conn.getSession(); session && session->has(PresenceIndex::userIdSlot())) {
+        sender = session->get(PresenceIndex::userIdSlot());
+    }
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 🔑 只入队，不等数据库；写失败时回到本 loop 通知发送者
+    std::weak_ptr<Connection> weak = conn.shared_from_this();
+    bool queued = context->messageWriter->write(
+        {std::move(channel), std::to_string(sender), std::string(text), std::to_string(nowMs)},
+        [weak](bool ok) {
+            if (ok) return;
+            if (auto c = weak.lock()) c->send(MessageBuffer::make("message not saved"));
+        },
+        loopExecutor(conn.loop()));
+    if (!queued) {
+        LOG_WARN("message writer queue full, message not persisted, conn={}", static_cast<void*>(&conn));
+    }
+}
+
+void RoomMessageHandler::onClose(WebSocketConnection& conn) {
+    m_rooms->detach(conn.shared_from_this());
+}
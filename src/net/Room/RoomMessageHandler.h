@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include "WsMessageHandler.h"
+#include "RoomManager.h"
+
+// 基于房间的文本协议：
+//   /join <room>          加入房间，并收到该房间最近的消息（启用 RoomHistory 时）
+//   /leave <room>         离开房间
+//   /say <room> <text>    向房间广播 "[room] text"（包括自己）
+//   /login <uid> <ticket> 校验登录票据后把当前 Session 标记为该用户，并取回离线消息；
+//                         票据是认证服务用 session.login_secret 签发的 SessionToken（purpose "login"），
+//                         未配置该 secret 时 /login 关闭
+//   /dm <uid> <text>      私信：用户在线时直接投递，否则写入离线日志
+// 其它文本按 EchoMessageHandler 的方式回显。
+// 连接建立时恢复 Session 原有的房间，关闭时从房间摘下。
+// 启用持久化时（ServerContext::messageWriter），/say 和 /dm 的消息经写后管道批量写入 MySQL。
+// 表结构：
+//   CREATE TABLE messages (
+//       id         BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+//       channel    VARCHAR(128) NOT NULL,        -- "room:<name>" 或 "user:<uid>"
+//       sender     BIGINT UNSIGNED NOT NULL,     -- 未 /login 时为 0
+//       content    TEXT NOT NULL,
+//       created_ms BIGINT NOT NULL,
+//       KEY idx_channel (channel, id)
+//   );
+class RoomMessageHandler : public WsMessageHandler {
+public:
+    explicit RoomMessageHandler(std::shared_ptr<RoomManager> rooms);
+
+    void onOpen(WebSocketConnection& conn) override;
+    void onText(WebSocketConnection& conn, std::string_view payload) override;
+    void onClose(WebSocketConnection& conn) override;
+
+private:
+    void onUserCommand(WebSocketConnection& conn, std::string_view command,
+                       std::string_view user, std::string_view text);
+    void persist(WebSocketConnection& conn, std::string channel, std::string_view text);
+
+    std::shared_ptr<RoomManager> m_rooms;
+};
@@ -0,0 +1,21 @@
+// Router/FileHandle.h
+#pragma once
+#include <unistd.h>
+
+// 持有一个只读文件描述符，析构时关闭。
+// 以 shared_ptr 在 worker 线程与 loop 线程之间传递，sendfile 完成后释放。
+class FileHandle {
+public:
+    explicit FileHandle(int fd) : m_fd(fd) {}
+    ~FileHandle() {
+        if (m_fd >= 0) ::close(m_fd);
+    }
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    int fd() const { return m_fd; }
+
+private:
+    int m_fd;
+};
@@ -0,0 +1,184 @@
+// Router/HttpRouter.cpp
+#include "HttpRouter.h"
+#include "Logger.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace http = boost::beast::http;
+
+namespace {
+// 取出 path 的第一段，path 前进到下一段（不含 '/'）
+std::string_view nextSegment(std::string_view& path) {
+    size_t pos = path.find('/');
+    std::string_view seg = path.substr(0, pos);
+    path = pos == std::string_view::npos ? std::string_view{} : path.substr(pos + 1);
+    return seg;
+}
+
+std::string_view stripSlashes(std::string_view path) {
+    while (!path.empty() && path.front() == '/') path.remove_prefix(1);
+    while (!path.empty() && path.back() == '/') path.remove_suffix(1);
+    return path;
+}
+}
+
+struct HttpRouter::Node {
+    // 静态子节点按段名排序，匹配时二分查找
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> children;
+    std::unique_ptr<Node> paramChild;       // ":name"
+    std::string paramName;
+    std::unique_ptr<Node> wildcardChild;    // "*name"，必须是最后一段
+    std::string wildcardName;
+    std::vector<std::pair<http::verb, Handler>> handlers;
+
+    Node* findChild(std::string_view seg) const {
+        auto it = std::lower_bound(children.begin(), children.end(), seg,
+            [](const auto& child, std::string_view key) { return child.first < key; });
+        if (it != children.end() && it->first == seg) return it->second.get();
+        return nullptr;
+    }
+
+    const Handler* find(http::verb method) const {
+        for (const auto& entry : handlers) {
+            if (entry.first == method) return &entry.second;
+        }
+        return nullptr;
+    }
+
+    // 节点有该方法的处理函数时返回 true；只是方法不符时记下第一个这样的节点
+    bool accepts(http::verb method, const Node*& partial) const {
+        if (handlers.empty()) return false;
+        if (find(method)) return true;
+        if (!partial) partial = this;
+        return false;
+    }
+
+    Node* addChild(std::string_view seg) {
+        auto it = std::lower_bound(children.begin(), children.end(), seg,
+            [](const auto& child, std::string_view key) { return child.first < key; });
+        if (it != children.end() && it->first == seg) return it->second.get();
+        it = children.emplace(it, std::string(seg), std::make_unique<Node>());
+        return it->second.get();
+    }
+};
+
+std::string_view RouteParams::get(std::string_view name) const {
+    for (size_t i = 0; i < m_size; ++i) {
+        if (m_params[i].first == name) return m_params[i].second;
+    }
+    return {};
+}
+
+bool RouteParams::push(std::string_view name, std::string_view value) {
+    if (m_size == kMaxParams) return false;
+    m_params[m_size++] = {name, value};
+    return true;
+}
+
+void HttpResponder::send(http::status status, std::string body, std::string_view contentType) const {
+    HttpResponse res;
+    res.result(status);
+    res.set(http::field::content_type, boost::beast::string_view(contentType.data(), contentType.size()));
+    res.body() = std::move(body);
+    send(std::move(res));
+}
+
+HttpRouter::HttpRouter() : m_root(std::make_unique<Node>()) {}
+
+HttpRouter::~HttpRouter() = default;
+
+void HttpRouter::add(http::verb method, std::string_view path, Handler handler) {
+    Node* node = m_root.get();
+    std::string_view rest = stripSlashes(path);
+
+    while (!rest.empty()) {
+        std::string_view seg = nextSegment(rest);
+        if (seg.empty()) continue;
+
+        if (seg.front() == ':') {
+            if (!node->paramChild) {
+                node->paramChild = std::make_unique<Node>();
+                node->paramName = std::string(seg.substr(1));
+            } else if (node->paramName != seg.substr(1)) {
+                throw std::invalid_argument("conflicting route parameter name: " + std::string(path));
+            }
+            node = node->paramChild.get();
+        } else if (seg.front() == '*') {
+            if (!rest.empty()) {
+                throw std::invalid_argument("wildcard must be the last segment: " + std::string(path));
+            }
+            if (!node->wildcardChild) {
+                node->wildcardChild = std::make_unique<Node>();
+                node->wildcardName = std::string(seg.substr(1));
+            }
+            node = node->wildcardChild.get();
+        } else {
+            node = node->addChild(seg);
+        }
+    }
+
+    for (auto& entry : node->handlers) {
+        if (entry.first == method) {
+            LOG_WARN("Route {} {} replaced", std::string(http::to_string(method)), path);
+            entry.second = std::move(handler);
+            return;
+        }
+    }
+    node->handlers.emplace_back(method, std::move(handler));
+    ++m_routeCount;
+    LOG_DEBUG("Route added: {} {}", std::string(http::to_string(method)), path);
+}
+
+void HttpRouter::get(std::string_view path, Handler handler) {
+    add(http::verb::get, path, std::move(handler));
+}
+
+void HttpRouter::post(std::string_view path, Handler handler) {
+    add(http::verb::post, path, std::move(handler));
+}
+
+HttpRouter::Result HttpRouter::match(http::verb method, std::string_view target,
+                                     const Handler*& handler, RouteParams& params) const {
+    std::string_view path = target.substr(0, target.find('?'));
+    const Node* partial = nullptr;
+    const Node* node = matchNode(m_root.get(), stripSlashes(path), method, params, partial);
+    if (node) {
+        handler = node->find(method);
+        return Result::Matched;
+    }
+    // 🔑 只有所有候选（静态、参数、通配）都没有该方法时才是 405
+    return partial ? Result::MethodNotAllowed : Result::NotFound;
+}
+
+const HttpRouter::Node* HttpRouter::matchNode(const Node* node, std::string_view path, http::verb method,
+                                              RouteParams& params, const Node*& partial) const {
+    if (path.empty()) {
+        if (node->accepts(method, partial)) return node;
+        // "/files/*path" 也匹配 "/files"
+        if (node->wildcardChild && params.push(node->wildcardName, {})) {
+            if (node->wildcardChild->accepts(method, partial)) return node->wildcardChild.get();
+            params.pop();
+        }
+        return nullptr;
+    }
+
+    std::string_view rest = path;
+    std::string_view seg = nextSegment(rest);
+
+    // 优先级：静态段 > 参数段 > 通配
+    if (const Node* child = node->findChild(seg)) {
+        if (const Node* found = matchNode(child, rest, method, params, partial)) return found;
+    }
+
+    if (node->paramChild && !seg.empty() && params.push(node->paramName, seg)) {
+        if (const Node* found = matchNode(node->paramChild.get(), rest, method, params, partial)) return found;
+        params.pop();
+    }
+
+    if (node->wildcardChild && params.push(node->wildcardName, path)) {
+        if (node->wildcardChild->accepts(method, partial)) return node->wildcardChild.get();
+        params.pop();
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,106 @@
+// Router/HttpRouter.h
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <boost/beast/http.hpp>
+#include "FileHandle.h"
+
+using HttpRequest = boost::beast::http::request<boost::beast::http::string_body>;
+using HttpResponse = boost::beast::http::response<boost::beast::http::string_body>;
+// 文件应答只携带头部，body 由连接用 sendfile 直接从文件发出
+using HttpFileHeader = boost::beast::http::response<boost::beast::http::empty_body>;
+
+// 路径参数，如 "/rooms/:id" 中的 id。
+// name/value 都是 string_view：name 指向路由表，value 指向请求的 target，
+// 在应答发出之前有效，异步处理时需要自行拷贝。
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 8;
+
+    std::string_view get(std::string_view name) const;
+    size_t size() const { return m_size; }
+    const std::pair<std::string_view, std::string_view>& operator[](size_t i) const { return m_params[i]; }
+
+private:
+    friend class HttpRouter;
+    bool push(std::string_view name, std::string_view value);
+    void pop() { --m_size; }
+
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> m_params;
+    size_t m_size = 0;
+};
+
+// 应答的接收方（HttpConnection 实现），reply 可在任意线程调用
+class HttpReplySink {
+public:
+    virtual ~HttpReplySink() = default;
+    virtual void reply(HttpResponse res) = 0;
+    // 发送 header 后用 sendfile 发送 file 的 [offset, offset + length)；
+    // 文件内容在 ThreadPool 上按块预取进 page cache 后才 sendfile，不在 loop 上读盘
+    virtual void replyFile(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                           uint64_t offset, uint64_t length) = 0;
+};
+
+// 交给路由处理函数的应答句柄。
+// 每个请求必须且只能调用一次 send()；可以在 ThreadPool / DB 回调中异步调用。
+class HttpResponder {
+public:
+    explicit HttpResponder(std::shared_ptr<HttpReplySink> sink) : m_sink(std::move(sink)) {}
+
+    void send(HttpResponse res) const { m_sink->reply(std::move(res)); }
+    void send(boost::beast::http::status status, std::string body,
+              std::string_view contentType = "text/plain") const;
+    void sendFile(HttpFileHeader header, std::shared_ptr<const FileHandle> file,
+                  uint64_t offset, uint64_t length) const {
+        m_sink->replyFile(std::move(header), std::move(file), offset, length);
+    }
+
+private:
+    std::shared_ptr<HttpReplySink> m_sink;
+};
+
+// 按 method + path 分发请求的路由表。
+// 路由在启动时注册，之后只读；匹配过程只比较 string_view，不做任何堆分配。
+// 路径语法："/static"、"/rooms/:id"（单段参数）、"/files/*path"（匹配剩余全部路径）
+class HttpRouter {
+public:
+    using Handler = std::function<void(const HttpRequest&, const RouteParams&, const HttpResponder&)>;
+
+    enum class Result {
+        Matched,
+        NotFound,
+        MethodNotAllowed
+    };
+
+    HttpRouter();
+    ~HttpRouter();
+
+    HttpRouter(const HttpRouter&) = delete;
+    HttpRouter& operator=(const HttpRouter&) = delete;
+
+    void add(boost::beast::http::verb method, std::string_view path, Handler handler);
+    void get(std::string_view path, Handler handler);
+    void post(std::string_view path, Handler handler);
+
+    // target 可以带 query string，匹配时会忽略 '?' 之后的部分
+    // 匹配成功时 handler 指向路由表中的处理函数，params 填入路径参数
+    Result match(boost::beast::http::verb method, std::string_view target,
+                 const Handler*& handler, RouteParams& params) const;
+
+    size_t routeCount() const { return m_routeCount; }
+
+private:
+    struct Node;
+
+    // 返回路径匹配且注册了 method 的节点；只有路径匹配的第一个节点记在 partial 里（用于 405）
+    const Node* matchNode(const Node* node, std::string_view path, boost::beast::http::verb method,
+                          RouteParams& params, const Node*& partial) const;
+
+    std::unique_ptr<Node> m_root;
+    size_t m_routeCount = 0;
+};
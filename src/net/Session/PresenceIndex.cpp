@@ -0,0 +1,191 @@
+#include "PresenceIndex.h"
+#include "Connection.h"
+#include "Session.h"
+#include "Logger.h"
+#include <algorithm>
+
+namespace {
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+}
+
+PresenceIndex::PresenceIndex(size_t bucketCount)
+    : m_mask(roundUpPow2(std::max<size_t>(bucketCount, kStripes)) - 1),
+      m_buckets(new std::atomic<const Node*>[m_mask + 1]),
+      m_stripes(new Stripe[kStripes]) {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+    userIdSlot();   // 在创建任何 Session 之前注册
+    LOG_INFO("Created, buckets={}", m_mask + 1);
+}
+
+PresenceIndex::~PresenceIndex() {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        const Node* node = m_buckets[i].load(std::memory_order_relaxed);
+        while (node) {
+            const Node* next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+}
+
+ScalarSlot<uint64_t> PresenceIndex::userIdSlot() {
+    static const auto slot = SessionSlots::scalar<uint64_t>("user_id");
+    return slot;
+}
+
+size_t PresenceIndex::bucketOf(uint64_t userId) const {
+    // 与 SessionManager 分片相同的乘法散列，连续的用户 id 也能打散
+    return static_cast<size_t>((userId * 0x9E3779B97F4A7C15ull) >> 32) & m_mask;
+}
+
+const PresenceIndex::Node* PresenceIndex::find(uint64_t userId) const {
+    const Node* node = m_buckets[bucketOf(userId)].load(std::memory_order_acquire);
+    while (node && node->userId != userId) {
+        node = node->next.load(std::memory_order_acquire);
+    }
+    return node;
+}
+
+void PresenceIndex::login(Session& session, uint64_t userId) {
+    // 🔑 与 attach/detach 串行：否则快照之后断开的连接会被重新登记，或快照之后接入的连接按旧 id 登记
+    std::lock_guard lock(session.presenceMutex());
+    const auto slot = userIdSlot();
+    bool loggedIn = session.has(slot);
+    uint64_t previous = loggedIn ? session.get(slot) : 0;
+    if (loggedIn && previous == userId) {
+        return;
+    }
+
+    auto connections = session.connections();
+    if (loggedIn) {
+        for (const auto& conn : connections) {
+            remove(previous, conn.get());
+        }
+    }
+    session.set(slot, userId);
+    for (const auto& conn : connections) {
+        add(userId, conn);
+    }
+    LOG_INFO("User logged in, sid={}, uid={}, connections={}", session.id(), userId, connections.size());
+}
+
+void PresenceIndex::connect(const Session& session, const std::shared_ptr<Connection>& conn) {
+    const auto slot = userIdSlot();
+    if (conn && session.has(slot)) {
+        add(session.get(slot), conn);
+    }
+}
+
+void PresenceIndex::disconnect(const Session& session, const Connection* conn) {
+    const auto slot = userIdSlot();
+    if (conn && session.has(slot)) {
+        remove(session.get(slot), conn);
+    }
+}
+
+void PresenceIndex::add(uint64_t userId, const std::shared_ptr<Connection>& conn) {
+    size_t bucket = bucketOf(userId);
+    std::lock_guard<std::mutex> lock(m_stripes[bucket % kStripes].mutex);
+
+    const Node* old = m_buckets[bucket].load(std::memory_order_relaxed);
+    while (old && old->userId != userId) {
+        old = old->next.load(std::memory_order_relaxed);
+    }
+
+    // 🔑 节点不可变：复制一份加上新连接，再整体替换
+    auto* node = new Node{userId, {}, {}, {}};
+    if (old) {
+        if (std::find(old->keys.begin(), old->keys.end(), conn.get()) != old->keys.end()) {
+            delete node;
+            return;
+        }
+        node->connections = old->connections;
+        node->keys = old->keys;
+    }
+    node->connections.push_back(conn);
+    node->keys.push_back(conn.get());
+
+    if (old) {
+        replaceLocked(bucket, old, node);
+    } else {
+        node->next.store(m_buckets[bucket].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        m_buckets[bucket].store(node, std::memory_order_release);
+        m_onlineUsers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PresenceIndex::remove(uint64_t userId, const Connection* conn) {
+    size_t bucket = bucketOf(userId);
+    std::lock_guard<std::mutex> lock(m_stripes[bucket % kStripes].mutex);
+
+    const Node* old = m_buckets[bucket].load(std::memory_order_relaxed);
+    while (old && old->userId != userId) {
+        old = old->next.load(std::memory_order_relaxed);
+    }
+    if (!old) return;
+
+    auto pos = std::find(old->keys.begin(), old->keys.end(), conn);
+    if (pos == old->keys.end()) return;
+
+    if (old->keys.size() == 1) {
+        replaceLocked(bucket, old, nullptr);
+        m_onlineUsers.fetch_sub(1, std::memory_order_relaxed);
+        return;
+    }
+
+    size_t index = static_cast<size_t>(pos - old->keys.begin());
+    auto* node = new Node{userId, old->connections, old->keys, {}};
+    node->connections.erase(node->connections.begin() + index);
+    node->keys.erase(node->keys.begin() + index);
+    replaceLocked(bucket, old, node);
+}
+
+void PresenceIndex::replaceLocked(size_t bucket, const Node* old, Node* replacement) {
+    const Node* next = old->next.load(std::memory_order_relaxed);
+    const Node* successor = next;
+    if (replacement) {
+        replacement->next.store(next, std::memory_order_relaxed);
+        successor = replacement;
+    }
+
+    // 找到指向 old 的那个指针（桶头或前驱的 next），一次 release 写完成替换；
+    // 正在遍历 old 的读者仍能沿 old->next 走完，old 本身等宽限期后释放
+    std::atomic<const Node*>* link = &m_buckets[bucket];
+    while (link->load(std::memory_order_relaxed) != old) {
+        link = &const_cast<Node*>(link->load(std::memory_order_relaxed))->next;
+    }
+    link->store(successor, std::memory_order_release);
+
+    m_qsbr.retire([old] { delete old; });
+}
+
+bool PresenceIndex::isOnline(uint64_t userId) const {
+    return find(userId) != nullptr;
+}
+
+size_t PresenceIndex::sendToUser(uint64_t userId, const MessageBuffer::Ptr& msg) const {
+    size_t sent = 0;
+    forEachConnection(userId, [&](const std::shared_ptr<Connection>& conn) {
+        conn->send(msg);
+        ++sent;
+    });
+    return sent;
+}
+
+size_t PresenceIndex::onlineUsers() const {
+    return m_onlineUsers.load(std::memory_order_relaxed);
+}
+
+size_t PresenceIndex::registerReader() {
+    return m_qsbr.registerReader();
+}
+
+void PresenceIndex::quiescent(size_t reader) {
+    m_qsbr.quiescent(reader);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MessageBuffer.h"
+#include "Qsbr.h"
+#include "SessionSlots.h"
+
+class Connection;
+class Session;
+
+// 在线用户索引：user id -> 该用户所有设备上的在线连接。
+// - 定长桶数组 + 每桶一条不可变节点链：查找是一次散列加一小段链表遍历，O(1)
+// - 读（isOnline / sendToUser / forEach）不加锁、不写共享变量，只能在注册为 QSBR 读者的
+//   EventLoop 线程上调用；各 loop 在时间轮 tick 上报告静止点（NetBootstrap 负责接线）
+// - 写（上线、下线）按桶分段加锁，替换节点后把旧节点交给 QSBR 延迟释放
+// 用户 id 存在 Session 的标量槽 "user_id" 里（登录时 login 设置，随快照持久化）；
+// Session::attach / detach 会自动维护索引。
+class PresenceIndex {
+public:
+    explicit PresenceIndex(size_t bucketCount = 65536);
+    ~PresenceIndex();
+
+    PresenceIndex(const PresenceIndex&) = delete;
+    PresenceIndex& operator=(const PresenceIndex&) = delete;
+
+    static ScalarSlot<uint64_t> userIdSlot();
+
+    // 登录：给 Session 设置用户 id，并把它当前的连接登记为该用户在线（换号时先下线旧 id）
+    void login(Session& session, uint64_t userId);
+
+    // 连接绑定到 / 离开一个已登录的 Session；未登录时什么也不做。
+    // 由 Session::attach / detach 在 presenceMutex 下调用
+    void connect(const Session& session, const std::shared_ptr<Connection>& conn);
+    void disconnect(const Session& session, const Connection* conn);
+
+    // ---- 读：只能在已注册的 loop 线程上调用 ----
+    bool isOnline(uint64_t userId) const;
+    // 发给该用户的所有在线连接，返回连接数
+    size_t sendToUser(uint64_t userId, const MessageBuffer::Ptr& msg) const;
+
+    template <class F>
+    void forEachConnection(uint64_t userId, F&& fn) const {
+        if (const Node* node = find(userId)) {
+            for (const auto& weak : node->connections) {
+                if (auto conn = weak.lock()) fn(conn);
+            }
+        }
+    }
+
+    size_t onlineUsers() const;
+
+    // ---- QSBR 接线 ----
+    size_t registerReader();
+    void quiescent(size_t reader);
+
+private:
+    struct Node {
+        uint64_t userId;
+        std::vector<std::weak_ptr<Connection>> connections;
+        std::vector<const Connection*> keys;        // 与 connections 一一对应
+        std::atomic<const Node*> next{nullptr};
+    };
+
+    static constexpr size_t kStripes = 256;
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+    };
+
+    size_t bucketOf(uint64_t userId) const;
+    const Node* find(uint64_t userId) const;
+
+    void add(uint64_t userId, const std::shared_ptr<Connection>& conn);
+    void remove(uint64_t userId, const Connection* conn);
+    // 在持有分段锁时把 old 替换为 replacement（为空表示删除），old 交给 QSBR
+    void replaceLocked(size_t bucket, const Node* old, Node* replacement);
+
+    const size_t m_mask;
+    std::unique_ptr<std::atomic<const Node*>[]> m_buckets;
+    std::unique_ptr<Stripe[]> m_stripes;
+    std::atomic<size_t> m_onlineUsers{0};
+    mutable Qsbr m_qsbr;
+};
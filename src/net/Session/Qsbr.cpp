@@ -0,0 +1,75 @@
+#include "Qsbr.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+Qsbr::Qsbr(size_t maxReaders)
+    : m_readers(new ReaderSlot[maxReaders]),
+      m_maxReaders(maxReaders) {
+}
+
+Qsbr::~Qsbr() {
+    // 析构时读者都已停止，剩下的直接释放
+    for (auto& r : m_retired) {
+        r.deleter();
+    }
+}
+
+size_t Qsbr::registerReader() {
+    size_t index = m_readerCount.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= m_maxReaders) {
+        m_readerCount.fetch_sub(1, std::memory_order_relaxed);
+        throw std::length_error("too many qsbr readers");
+    }
+    // 槽位初值为 0：在写入当前 epoch 之前，reclaim 看到它只会更保守，不会提前释放
+    m_readers[index].epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_release);
+    return index;
+}
+
+void Qsbr::quiescent(size_t reader) {
+    // 🔑 release：本线程此前对旧对象的读取都发生在这次报告之前
+    m_readers[reader].epoch.store(m_epoch.load(std::memory_order_seq_cst), std::memory_order_release);
+
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (lock.owns_lock() && !m_retired.empty()) {
+        reclaimLocked(lock);
+    }
+}
+
+void Qsbr::retire(std::function<void()> deleter) {
+    // 对象已经摘下；此后读到新 epoch 的读者不可能再看到它
+    uint64_t epoch = m_epoch.fetch_add(1, std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_retired.push_back(Retired{epoch, std::move(deleter)});
+}
+
+size_t Qsbr::reclaim() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return reclaimLocked(lock);
+}
+
+size_t Qsbr::reclaimLocked(std::unique_lock<std::mutex>& lock) {
+    // 所有读者都报告过大于 epoch 的值，说明它们都在 retire 之后经过了静止点
+    uint64_t safe = std::numeric_limits<uint64_t>::max();
+    size_t readers = std::min(m_readerCount.load(std::memory_order_acquire), m_maxReaders);
+    for (size_t i = 0; i < readers; ++i) {
+        safe = std::min(safe, m_readers[i].epoch.load(std::memory_order_acquire));
+    }
+
+    auto split = std::partition(m_retired.begin(), m_retired.end(),
+        [safe](const Retired& r) { return r.epoch >= safe; });
+    std::vector<Retired> ready(std::make_move_iterator(split), std::make_move_iterator(m_retired.end()));
+    m_retired.erase(split, m_retired.end());
+
+    // deleter 在锁外执行
+    lock.unlock();
+    for (auto& r : ready) {
+        r.deleter();
+    }
+    return ready.size();
+}
+
+size_t Qsbr::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_retired.size();
+}
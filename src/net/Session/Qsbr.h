@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 静止状态回收（QSBR，quiescent-state-based reclamation）。
+// 读者是各个 EventLoop 线程：读路径上什么都不做（不加锁、不写共享变量），
+// 只需在两次读之间的"静止点"（例如时间轮 tick 回调里）调用 quiescent()。
+// 写者把摘下的旧对象交给 retire()，等所有读者都经过一次静止点后才真正释放。
+// 约束：读到的指针不能跨过本线程的静止点继续使用；未注册的线程不能读。
+class Qsbr {
+public:
+    explicit Qsbr(size_t maxReaders = 256);
+    ~Qsbr();
+
+    Qsbr(const Qsbr&) = delete;
+    Qsbr& operator=(const Qsbr&) = delete;
+
+    // 返回读者编号；应在该线程开始读之前调用，超出容量抛 std::length_error
+    size_t registerReader();
+
+    // 读者报告静止：此前读到的指针都不再使用。顺带尝试回收（拿不到锁就跳过，不阻塞 loop）
+    void quiescent(size_t reader);
+
+    // 写者调用：对象已从数据结构上摘下，等宽限期过后执行 deleter
+    void retire(std::function<void()> deleter);
+
+    // 释放所有已过宽限期的对象，返回释放数量
+    size_t reclaim();
+
+    size_t pending() const;
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    struct Retired {
+        uint64_t epoch;
+        std::function<void()> deleter;
+    };
+
+    size_t reclaimLocked(std::unique_lock<std::mutex>& lock);
+
+    std::atomic<uint64_t> m_epoch{1};
+    std::unique_ptr<ReaderSlot[]> m_readers;
+    const size_t m_maxReaders;
+    std::atomic<size_t> m_readerCount{0};
+
+    mutable std::mutex m_mutex;
+    std::vector<Retired> m_retired;
+};
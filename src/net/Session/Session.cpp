@@ -1,8 +1,17 @@
 #include "Session.h"
 #include "Connection.h"
+#include "PresenceIndex.h"
 #include "Logger.h"
+#include <chrono>
 
-Session::Session(uint64_t id) : m_id(id) {
+namespace {
+int64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+Session::Session(uint64_t id) : m_id(id), m_lastActiveMs(steadyNowMs()) {
     LOG_INFO("Created, sid={}", m_id);
 }
 
@@ -31,14 +40,65 @@ bool Session::has(const std::string& key) const {
 
 void Session::attach(const std::shared_ptr<Connection>& conn) {
     LOG_INFO("attach called, sid={}, conn={}", m_id, static_cast<const void*>(conn.get()));
-    std::lock_guard lock(m_mutex);
-    m_connections.insert(conn);
+    std::lock_guard presenceLock(m_presenceMutex);
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_connections.insert(conn).second) {
+            return;
+        }
+        m_attached.fetch_add(1, std::memory_order_relaxed);
+    }
+    // 已登录的 Session：本连接也算该用户在线
+    if (m_presence) {
+        m_presence->connect(*this, conn);
+    }
 }
 
 void Session::detach(const std::shared_ptr<Connection>& conn) {
     LOG_INFO("detach called, sid={}, conn={}", m_id, static_cast<const void*>(conn.get()));
+    std::lock_guard presenceLock(m_presenceMutex);
+    if (m_presence) {
+        m_presence->disconnect(*this, conn.get());
+    }
     std::lock_guard lock(m_mutex);
-    m_connections.erase(conn);
+    if (m_connections.erase(conn) > 0) {
+        // 先更新空闲起点，再减计数：sweep 看到 0 个连接时，时间戳一定是新的
+        m_lastActiveMs.store(steadyNowMs(), std::memory_order_relaxed);
+        m_attached.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void Session::touch() {
+    m_lastActiveMs.store(steadyNowMs(), std::memory_order_relaxed);
+}
+
+int64_t Session::lastActiveMs() const {
+    return m_lastActiveMs.load(std::memory_order_relaxed);
+}
+
+void Session::setLastActiveMs(int64_t ms) {
+    m_lastActiveMs.store(ms, std::memory_order_relaxed);
+}
+
+size_t Session::connectionCount() const {
+    return m_attached.load(std::memory_order_acquire);
+}
+
+void Session::setTtl(uint64_t ttlMs) {
+    m_ttlMs.store(ttlMs, std::memory_order_relaxed);
+}
+
+uint64_t Session::ttlMs() const {
+    return m_ttlMs.load(std::memory_order_relaxed);
+}
+
+bool Session::expired(int64_t nowMs, uint64_t defaultTtlMs) const {
+    if (m_attached.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    uint64_t ttl = m_ttlMs.load(std::memory_order_relaxed);
+    if (ttl == 0) ttl = defaultTtlMs;
+    return m_lastActiveMs.load(std::memory_order_relaxed) + static_cast<int64_t>(ttl) <= nowMs;
 }
 
 bool Session::empty() const {
@@ -46,3 +106,20 @@ bool Session::empty() const {
     std::lock_guard lock(m_mutex);
     return m_connections.empty();
 }
+
+std::vector<std::shared_ptr<Connection>> Session::connections() const {
+    std::lock_guard lock(m_mutex);
+    return {m_connections.begin(), m_connections.end()};
+}
+
+void Session::setPresence(std::shared_ptr<PresenceIndex> presence) {
+    m_presence = std::move(presence);
+}
+
+const std::shared_ptr<PresenceIndex>& Session::presence() const {
+    return m_presence;
+}
+
+std::mutex& Session::presenceMutex() const {
+    return m_presenceMutex;
+}
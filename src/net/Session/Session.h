@@ -2,13 +2,17 @@
 #include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include <any>
 #include <memory>
 #include <string>
 #include <mutex>
+#include <atomic>
 #include "Connection.h"
+#include "SessionSlots.h"
 
 class Connection;
+class PresenceIndex;
 
 class Session : public std::enable_shared_from_this<Session> {
 public:
@@ -18,20 +22,65 @@ public:
 
     uint64_t id() const;
 
-    // ---- 业务数据 ----
+    // ---- 类型化属性（热点数据，见 SessionSlots.h）：无锁，不打日志 ----
+    template <class T>
+    void set(ScalarSlot<T> slot, T value) { m_slots.set(slot, value); }
+    template <class T>
+    T get(ScalarSlot<T> slot) const { return m_slots.get(slot); }
+    template <class T>
+    bool has(ScalarSlot<T> slot) const { return m_slots.has(slot); }
+
+    template <class T>
+    void set(ObjectSlot<T> slot, std::shared_ptr<const T> value) { m_slots.set(slot, std::move(value)); }
+    template <class T>
+    std::shared_ptr<const T> get(ObjectSlot<T> slot) const { return m_slots.get(slot); }
+    template <class T>
+    bool has(ObjectSlot<T> slot) const { return m_slots.has(slot); }
+
+    // 快照保存/恢复时直接访问槽位
+    SessionSlotStorage& slots() { return m_slots; }
+    const SessionSlotStorage& slots() const { return m_slots; }
+
+    // ---- 业务数据（字符串 key，不常用的数据）----
     void set(const std::string& key, std::any value);
     std::any get(const std::string& key) const;
     bool has(const std::string& key) const;
 
     // ---- 连接管理（重点）----
+    // 已登录时顺带维护在线索引：连接集合和索引在 presenceMutex 下一起变，不会与 login 交错
     void attach(const std::shared_ptr<Connection>& conn);
     void detach(const std::shared_ptr<Connection>& conn);
     bool empty() const;
+    std::vector<std::shared_ptr<Connection>> connections() const;
+
+    // 所属 SessionManager 的在线索引（由 SessionManager 在创建时设置）
+    void setPresence(std::shared_ptr<PresenceIndex> presence);
+    const std::shared_ptr<PresenceIndex>& presence() const;
+    // 串行化 attach/detach 与 PresenceIndex::login（只在这三处持有，先于 m_mutex 加锁）
+    std::mutex& presenceMutex() const;
+
+    // ---- 过期（由 SessionManager 判断和回收）----
+    // 有连接时永不过期；最后一个连接断开后，空闲超过 TTL 即过期。
+    // 滑动过期：断开、被查找/恢复（touch）都会把空闲起点推到当前时刻。
+    void touch();
+    int64_t lastActiveMs() const;           // steady clock 毫秒
+    void setLastActiveMs(int64_t ms);       // 从快照恢复空闲起点
+    size_t connectionCount() const;
+    // 单个 Session 的 TTL，0 表示使用 SessionManager 的默认值
+    void setTtl(uint64_t ttlMs);
+    uint64_t ttlMs() const;
+    bool expired(int64_t nowMs, uint64_t defaultTtlMs) const;
 
 private:
     uint64_t m_id;
+    SessionSlotStorage m_slots;
 
+    mutable std::mutex m_presenceMutex;
     mutable std::mutex m_mutex;
     std::unordered_map<std::string, std::any> m_data;
     std::unordered_set<std::shared_ptr<Connection>> m_connections;
+    std::atomic<uint32_t> m_attached{0};        // 与 m_connections.size() 一致，无锁读取
+    std::atomic<int64_t> m_lastActiveMs;
+    std::atomic<uint64_t> m_ttlMs{0};
+    std::shared_ptr<PresenceIndex> m_presence;
 };
\ No newline at end of file
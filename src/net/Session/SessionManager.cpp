@@ -1,39 +1,143 @@
 #include "SessionManager.h"
+#include "SessionSnapshot.h"
 #include "Logger.h"
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace {
+// 🔑 随机 64 位 id：不随重启重复，快照丢失或过期后旧令牌也不会对上别人的新 Session
+uint64_t randomSessionId() {
+    thread_local std::mt19937_64 rng([] {
+        std::random_device rd;
+        std::seed_seq seq{rd(), rd(), rd(), rd(), rd(), rd(), rd(), rd()};
+        return std::mt19937_64(seq);
+    }());
+    uint64_t id;
+    do {
+        id = rng();
+    } while (id == 0);      // 0 保留给"没有 Session"
+    return id;
+}
+
+uint64_t wallNowSec() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+int64_t wallNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
 
 SessionManager::SessionManager()
-    : m_nextSessionId(1) {
-    LOG_INFO("Created");
+    : SessionManager(Options{}) {
+}
+
+SessionManager::SessionManager(Options options)
+    : m_options(std::move(options)),
+      m_tokens(m_options.secret),
+      m_presence(std::make_shared<PresenceIndex>(m_options.presenceBuckets)) {
+    if (m_options.sweepBatch == 0) m_options.sweepBatch = 1;
+    LOG_INFO("Created, shards={}, token_ttl={}s, session_ttl={}ms, sweep_batch={}",
+             kShardCount, m_options.tokenTtlSec, m_options.defaultTtlMs, m_options.sweepBatch);
+}
+
+// SessionSnapshot 在这里是完整类型
+SessionManager::~SessionManager() = default;
+
+SessionManager::Shard& SessionManager::shardFor(uint64_t sessionId) {
+    // 乘法散列后取高位；id 本身已是随机的，这一步只是让分片不依赖 id 的某几位
+    uint64_t h = sessionId * 0x9E3779B97F4A7C15ull;
+    return m_shards[h >> (64 - kShardBits)];
 }
 
 SessionManager::SessionPtr SessionManager::createSession() {
-    uint64_t id = m_nextSessionId.fetch_add(1, std::memory_order_relaxed);
-    LOG_INFO("Creating session, id={}", id);
+    for (;;) {
+        uint64_t id = randomSessionId();
+        // 热重启期间还要避开快照里尚未恢复的 id
+        if (m_hasSnapshot.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_snapshotMutex);
+            if (m_snapshot && m_snapshot->find(id) != SessionSnapshot::npos) {
+                continue;
+            }
+        }
 
-    auto session = std::make_shared<Session>(id);
+        auto session = std::make_shared<Session>(id);
+        session->setPresence(m_presence);
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_sessions.emplace(id, session);
-        LOG_DEBUG("Session stored, id={}", id);
+        {
+            Shard& shard = shardFor(id);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            // 撞上现有 id 的概率可以忽略，但绝不能覆盖别人的 Session
+            if (!shard.sessions.emplace(id, session).second) {
+                continue;
+            }
+        }
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("Session created, id={}", id);
+        return session;
     }
-
-    return session;
 }
 
 SessionManager::SessionPtr SessionManager::getSession(uint64_t sessionId) {
     LOG_DEBUG("getSession called, id={}", sessionId);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    SessionPtr session;
+    {
+        Shard& shard = shardFor(sessionId);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        if (it != shard.sessions.end()) {
+            session = it->second;
+        }
+    }
+
+    if (!session && m_hasSnapshot.load(std::memory_order_acquire)) {
+        session = restoreFromSnapshot(sessionId);
+    }
+
+    if (!session) {
+        LOG_DEBUG("Session not found, id={}", sessionId);
+        return nullptr;
+    }
 
-    auto it = m_sessions.find(sessionId);
-    if (it != m_sessions.end()) {
-        LOG_DEBUG("Session found, id={}", sessionId);
-        return it->second;
+    // 🔑 惰性过期：已过期但 sweep 还没扫到的，查找时直接回收
+    int64_t now = steadyNowMs();
+    if (session->expired(now, m_options.defaultTtlMs)) {
+        removeIfExpired(sessionId, now);
+        LOG_DEBUG("Session expired on lookup, id={}", sessionId);
+        return nullptr;
     }
 
-    LOG_DEBUG("Session not found, id={}", sessionId);
-    return nullptr;
+    session->touch();
+    LOG_DEBUG("Session found, id={}", sessionId);
+    return session;
+}
+
+bool SessionManager::removeIfExpired(uint64_t sessionId, int64_t nowMs) {
+    SessionPtr removed;
+    {
+        Shard& shard = shardFor(sessionId);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        // 拿到写锁后再确认一次：期间可能已被别人移除或重新接上连接
+        if (it == shard.sessions.end() || !it->second->expired(nowMs, m_options.defaultTtlMs)) {
+            return false;
+        }
+        removed = std::move(it->second);
+        shard.sessions.erase(it);
+    }
+    m_count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
 }
 
 void SessionManager::tryRemoveSession(const SessionPtr& session) {
@@ -50,28 +154,270 @@ void SessionManager::tryRemoveSession(const SessionPtr& session) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_sessions.erase(session->id());
-    LOG_INFO("Session removed, sid={}", session->id());
+    removeSession(session->id());
 }
 
 void SessionManager::removeSession(uint64_t sessionId) {
     LOG_INFO("removeSession called, id={}", sessionId);
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_sessions.erase(sessionId);
+    // Session 在锁外析构
+    SessionPtr removed;
+    {
+        Shard& shard = shardFor(sessionId);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        if (it == shard.sessions.end()) {
+            return;
+        }
+        removed = std::move(it->second);
+        shard.sessions.erase(it);
+    }
+    m_count.fetch_sub(1, std::memory_order_relaxed);
+    LOG_INFO("Session removed, sid={}", sessionId);
 }
 
 void SessionManager::removeAllSessions() {
     LOG_INFO("removeAllSessions called");
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_sessions.clear();
+    for (Shard& shard : m_shards) {
+        std::unordered_map<uint64_t, SessionPtr> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            removed.swap(shard.sessions);
+        }
+        m_count.fetch_sub(removed.size(), std::memory_order_relaxed);
+    }
+}
+
+std::string SessionManager::issueResumeToken(const SessionPtr& session) const {
+    if (!session) return {};
+    return m_tokens.issue(session->id(), wallNowSec() + m_options.tokenTtlSec);
+}
+
+SessionManager::SessionPtr SessionManager::resumeSession(std::string_view token) {
+    auto sid = m_tokens.verify(token, wallNowSec());
+    if (!sid) {
+        LOG_DEBUG("resume token rejected");
+        return nullptr;
+    }
+
+    auto session = getSession(*sid);
+    if (!session) {
+        LOG_INFO("resume failed, session expired, sid={}", *sid);
+        return nullptr;
+    }
+
+    LOG_INFO("Session resumed, sid={}", *sid);
+    return session;
+}
+
+size_t SessionManager::sweepExpired() {
+    const int64_t now = steadyNowMs();
+    size_t budget = m_options.sweepBatch;
+    std::vector<SessionPtr> expired;        // 锁外析构
+    std::vector<uint64_t> keys;
+
+    for (size_t visited = 0; budget > 0 && visited < kShardCount; ++visited) {
+        Shard& shard = m_shards[m_sweepShard];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto& sessions = shard.sessions;
+
+        // 桶数在持锁期间不变（erase 不会 rehash），游标按桶推进，每个桶至少消耗 1 个配额
+        size_t buckets = sessions.bucket_count();
+        while (budget > 0 && m_sweepBucket < buckets) {
+            size_t bucket = m_sweepBucket++;
+            size_t entries = sessions.bucket_size(bucket);
+            budget -= std::min(budget, std::max<size_t>(entries, 1));
+
+            for (auto it = sessions.begin(bucket); it != sessions.end(bucket); ++it) {
+                if (it->second->expired(now, m_options.defaultTtlMs)) {
+                    keys.push_back(it->first);
+                }
+            }
+            for (uint64_t key : keys) {
+                auto it = sessions.find(key);
+                expired.push_back(std::move(it->second));
+                sessions.erase(it);
+            }
+            keys.clear();
+        }
+
+        if (m_sweepBucket < buckets) {
+            break;      // 配额用完，下次从这个桶继续
+        }
+
+        // 整个分片扫完：大量回收后收缩桶数组，让内存跟随在线规模
+        if (buckets > 64 && sessions.size() * 8 < buckets) {
+            sessions.rehash(0);
+        }
+        m_sweepShard = (m_sweepShard + 1) % kShardCount;
+        m_sweepBucket = 0;
+    }
+
+    if (m_hasSnapshot.load(std::memory_order_acquire)) {
+        releaseSnapshotIfDrained();
+    }
+
+    size_t removed = expired.size();
+    if (removed > 0) {
+        m_count.fetch_sub(removed, std::memory_order_relaxed);
+        expired.clear();
+        LOG_INFO("Swept {} expired sessions, remaining={}", removed, size());
+    }
+    return removed;
+}
+
+const SessionManager::Options& SessionManager::options() const {
+    return m_options;
+}
+
+const std::shared_ptr<PresenceIndex>& SessionManager::presence() const {
+    return m_presence;
+}
+
+bool SessionManager::saveSnapshot(const std::string& path) const {
+    const int64_t steadyNow = steadyNowMs();
+    const int64_t wallNow = wallNowMs();
+    std::vector<SessionSnapshot::Record> records;
+    records.reserve(size());
+
+    for (const Shard& shard : m_shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& [id, session] : shard.sessions) {
+            uint64_t ttl = session->ttlMs() ? session->ttlMs() : m_options.defaultTtlMs;
+            // 🔑 还挂着连接的 Session 在停服时会被断开，宽限期从现在开始算
+            int64_t remaining = static_cast<int64_t>(ttl);
+            if (session->connectionCount() == 0) {
+                remaining -= steadyNow - session->lastActiveMs();
+            }
+            if (remaining <= 0) {
+                continue;
+            }
+
+            SessionSnapshot::Record record{};
+            record.id = id;
+            record.expiresAtWallMs = wallNow + remaining;
+            record.ttlMs = session->ttlMs();
+            const SessionSlotStorage& slots = session->slots();
+            record.scalarMask = slots.scalarMask();
+            for (uint32_t i = 0; i < SessionSlots::kMaxScalarSlots; ++i) {
+                if (record.scalarMask & (1ull << i)) {
+                    record.scalars[i] = slots.rawScalar(i);
+                }
+            }
+            records.push_back(record);
+        }
+    }
+
+    // 上次快照里还没被找回的 Session 原样带上，连续重启不会丢
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        if (m_snapshot) {
+            for (size_t i = 0; i < m_snapshot->size(); ++i) {
+                const auto& record = m_snapshot->record(i);
+                if (!m_restored[i] && record.expiresAtWallMs > wallNow) {
+                    records.push_back(record);
+                }
+            }
+        }
+    }
+
+    size_t count = records.size();
+    if (!SessionSnapshot::write(path, SessionSlots::scalarNames(), std::move(records))) {
+        return false;
+    }
+    LOG_INFO("Session snapshot saved, path={}, sessions={}", path, count);
+    return true;
+}
+
+bool SessionManager::loadSnapshot(const std::string& path) {
+    auto snapshot = SessionSnapshot::open(path);
+    if (!snapshot) {
+        return false;
+    }
+
+    size_t count = snapshot->size();
+    LOG_INFO("Session snapshot loaded, path={}, sessions={}", path, count);
+    if (count == 0) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    m_snapshot = std::move(snapshot);
+    m_restored.assign(count, false);
+    m_hasSnapshot.store(true, std::memory_order_release);
+    return true;
+}
+
+SessionManager::SessionPtr SessionManager::restoreFromSnapshot(uint64_t sessionId) {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    if (!m_snapshot) {
+        return nullptr;
+    }
+
+    size_t index = m_snapshot->find(sessionId);
+    if (index == SessionSnapshot::npos) {
+        return nullptr;
+    }
+
+    Shard& shard = shardFor(sessionId);
+    if (m_restored[index]) {
+        // 可能刚被另一个线程恢复：在我们第一次查分片之后才插入
+        std::shared_lock<std::shared_mutex> shardLock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        return it != shard.sessions.end() ? it->second : nullptr;
+    }
+    m_restored[index] = true;
+
+    const SessionSnapshot::Record& record = m_snapshot->record(index);
+    int64_t remaining = record.expiresAtWallMs - wallNowMs();
+    if (remaining <= 0) {
+        LOG_DEBUG("Snapshot session expired, id={}", sessionId);
+        return nullptr;
+    }
+
+    auto session = std::make_shared<Session>(sessionId);
+    session->setPresence(m_presence);
+    session->setTtl(record.ttlMs);
+    for (uint32_t i = 0; i < SessionSlots::kMaxScalarSlots; ++i) {
+        if (!(record.scalarMask & (1ull << i))) {
+            continue;
+        }
+        int slot = m_snapshot->remapScalar(i);
+        if (slot >= 0) {
+            session->slots().restoreScalar(static_cast<uint32_t>(slot), record.scalars[i]);
+        }
+    }
+    // 把剩余宽限期换算回本进程的 steady clock
+    int64_t ttl = static_cast<int64_t>(record.ttlMs ? record.ttlMs : m_options.defaultTtlMs);
+    session->setLastActiveMs(steadyNowMs() - std::max<int64_t>(ttl - remaining, 0));
+
+    {
+        std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+        shard.sessions.emplace(sessionId, session);
+    }
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    LOG_INFO("Session restored from snapshot, id={}", sessionId);
+    return session;
+}
+
+void SessionManager::releaseSnapshotIfDrained() {
+    std::unique_ptr<SessionSnapshot> released;      // 锁外 munmap
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotMutex);
+        if (!m_snapshot || m_snapshot->maxExpiresAtWallMs() > wallNowMs()) {
+            return;
+        }
+        released = std::move(m_snapshot);
+        m_restored.clear();
+        m_hasSnapshot.store(false, std::memory_order_release);
+    }
+    LOG_INFO("Session snapshot released, all entries expired");
 }
 
 size_t SessionManager::size() const {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    size_t sz = m_sessions.size();
+    size_t sz = m_count.load(std::memory_order_relaxed);
     LOG_DEBUG("size queried, count={}", sz);
     return sz;
 }
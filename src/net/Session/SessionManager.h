@@ -2,22 +2,52 @@
 
 #include <unordered_map>
 #include <memory>
-#include <mutex>
+#include <shared_mutex>
 #include <atomic>
+#include <array>
 #include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "Session.h"
+#include "SessionToken.h"
+#include "PresenceIndex.h"
 
+class SessionSnapshot;
+
+// Session 表按 id 分成 kShardCount 个分片，每个分片一把读写锁：
+// 查找（最频繁）只拿对应分片的共享锁，不同分片的增删互不影响；
+// 总数单独用原子变量维护，size() 不加锁。
+// 过期回收两条路径：查找时惰性回收；定时 sweep 每次最多检查固定数量的条目，
+// 按 (分片, 桶) 游标逐步推进，任何一次调用都不会长时间占用 loop。
+// 热重启：停服时 saveSnapshot 写出快照，启动时 loadSnapshot 只做 mmap 和校验，
+// 快照里的 Session 在第一次被查找时才恢复进分片表。快照只保存标量属性槽，
+// 对象槽（如房间成员关系）不持久化，恢复后由业务层重建。
 class SessionManager {
 public:
+    static constexpr unsigned kShardBits = 6;
+    static constexpr size_t kShardCount = size_t(1) << kShardBits;
+
     using SessionPtr = std::shared_ptr<Session>;
 
+    struct Options {
+        std::string secret;                 // 恢复令牌签名密钥，为空时随机生成
+        uint64_t tokenTtlSec = 24 * 3600;   // 恢复令牌有效期
+        uint64_t defaultTtlMs = 60000;      // 最后一个连接断开后 Session 保留多久（滑动），可被 Session::setTtl 覆盖
+        size_t sweepBatch = 1024;           // 每次 sweep 最多检查的条目数
+        size_t presenceBuckets = 65536;     // 在线索引的桶数（固定不扩容，取在线用户量级）
+    };
+
     SessionManager();
+    explicit SessionManager(Options options);
+    ~SessionManager();
 
-    // 创建一个新 Session
+    // 创建一个新 Session，id 为随机 64 位（非 0），不随重启重复
     SessionPtr createSession();
 
-    // 通过 id 获取 Session
+    // 通过 id 获取 Session；已过期的就地回收并返回 nullptr，否则刷新其空闲计时
     SessionPtr getSession(uint64_t sessionId);
 
     // 当 Connection 断开后调用，用于尝试回收 Session
@@ -29,8 +59,52 @@ public:
 
     size_t size() const;
 
+    // 为 session 签发恢复令牌（登录成功 / 握手时下发给客户端）
+    std::string issueResumeToken(const SessionPtr& session) const;
+
+    // 校验令牌并找回仍在宽限期内的 Session；只查内存，不访问数据库
+    SessionPtr resumeSession(std::string_view token);
+
+    // 增量回收过期 Session：从上次停下的位置继续，最多检查 options.sweepBatch 个条目，
+    // 返回本次移除的数量；由 NetBootstrap 在 accept loop 的时间轮上定期调用
+    size_t sweepExpired();
+
+    const Options& options() const;
+
+    // 在线用户索引（user id -> 在线连接），本管理器创建的 Session 都挂在它上面
+    const std::shared_ptr<PresenceIndex>& presence() const;
+
+    // ---- 热重启快照 ----
+    // 写出当前所有未过期的 Session（以及已加载快照中尚未恢复的条目）；过期时间按墙上时间保存
+    bool saveSnapshot(const std::string& path) const;
+    // 打开快照，之后 getSession 未命中时按 id 从快照恢复；文件不存在返回 false
+    bool loadSnapshot(const std::string& path);
+
 private:
-    std::atomic<uint64_t> m_nextSessionId;
-    std::unordered_map<uint64_t, SessionPtr> m_sessions;
-    mutable std::mutex m_mutex;
+    // 🔑 每个分片独占缓存行，避免相邻分片的锁互相伪共享
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint64_t, SessionPtr> sessions;
+    };
+
+    Shard& shardFor(uint64_t sessionId);
+    bool removeIfExpired(uint64_t sessionId, int64_t nowMs);
+    SessionPtr restoreFromSnapshot(uint64_t sessionId);
+    void releaseSnapshotIfDrained();
+
+    Options m_options;
+    SessionToken m_tokens;
+    std::shared_ptr<PresenceIndex> m_presence;
+    std::atomic<size_t> m_count{0};
+    std::array<Shard, kShardCount> m_shards;
+
+    // sweep 游标：只在调用 sweepExpired 的线程上访问
+    size_t m_sweepShard = 0;
+    size_t m_sweepBucket = 0;
+
+    // 已加载的快照；锁顺序：m_snapshotMutex -> 分片锁
+    mutable std::mutex m_snapshotMutex;
+    std::unique_ptr<SessionSnapshot> m_snapshot;
+    std::vector<bool> m_restored;           // 快照条目是否已恢复（或已过期作废）
+    std::atomic<bool> m_hasSnapshot{false}; // 查找未命中时的快速判断，没有快照就不碰锁
 };
@@ -0,0 +1,68 @@
+#include "SessionSlots.h"
+#include "Logger.h"
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::pair<int, uint32_t>> slots;    // name -> (kind, index)
+    uint32_t scalarCount = 0;
+    uint32_t objectCount = 0;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+}
+
+std::vector<std::string> SessionSlots::scalarNames() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::vector<std::string> names(r.scalarCount);
+    for (const auto& [name, slot] : r.slots) {
+        if (slot.first == static_cast<int>(Kind::Scalar)) {
+            names[slot.second] = name;
+        }
+    }
+    return names;
+}
+
+int SessionSlots::findScalar(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    auto it = r.slots.find(name);
+    if (it == r.slots.end() || it->second.first != static_cast<int>(Kind::Scalar)) {
+        return -1;
+    }
+    return static_cast<int>(it->second.second);
+}
+
+uint32_t SessionSlots::registerSlot(const std::string& name, Kind kind) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    auto it = r.slots.find(name);
+    if (it != r.slots.end()) {
+        if (it->second.first != static_cast<int>(kind)) {
+            throw std::logic_error("session slot '" + name + "' registered with another kind");
+        }
+        return it->second.second;
+    }
+
+    uint32_t& count = kind == Kind::Scalar ? r.scalarCount : r.objectCount;
+    uint32_t capacity = kind == Kind::Scalar ? kMaxScalarSlots : kMaxObjectSlots;
+    if (count >= capacity) {
+        throw std::logic_error("too many session slots, cannot register '" + name + "'");
+    }
+
+    uint32_t index = count++;
+    r.slots.emplace(name, std::make_pair(static_cast<int>(kind), index));
+    LOG_INFO("Session slot registered, name={}, kind={}, index={}",
+             name, kind == Kind::Scalar ? "scalar" : "object", index);
+    return index;
+}
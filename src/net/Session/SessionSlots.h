@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// ---- Session 的类型化属性槽 ----
+// 热点属性（用户 id、权限等级、所在房间列表）在启动时注册一次，得到一个小整数下标，
+// 值直接存放在 Session 内部的定长数组里：
+// - ScalarSlot<T>：不超过 8 字节的平凡类型，存在 atomic<uint64_t> 里，读写无锁
+// - ObjectSlot<T>：不可变对象，以 shared_ptr<const T> 原子替换，读者拿到快照，不拷贝对象
+// 用法：
+//   static const auto kUserId = SessionSlots::scalar<uint64_t>("user_id");
+//   session->set(kUserId, uid);
+//   uint64_t uid = session->get(kUserId);
+// 同名重复注册返回同一个槽；字符串 key 的 set/get 仍保留给不常用的数据。
+
+template <class T>
+struct ScalarSlot {
+    static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(uint64_t),
+                  "ScalarSlot holds trivially copyable values of at most 8 bytes");
+    uint32_t index;
+};
+
+template <class T>
+struct ObjectSlot {
+    uint32_t index;
+};
+
+class SessionSlots {
+public:
+    static constexpr uint32_t kMaxScalarSlots = 16;
+    static constexpr uint32_t kMaxObjectSlots = 8;
+
+    // 在创建任何 Session 之前（启动阶段）调用；超出容量或同名不同类别时抛 std::logic_error
+    template <class T>
+    static ScalarSlot<T> scalar(const std::string& name) {
+        return ScalarSlot<T>{registerSlot(name, Kind::Scalar)};
+    }
+
+    template <class T>
+    static ObjectSlot<T> object(const std::string& name) {
+        return ObjectSlot<T>{registerSlot(name, Kind::Object)};
+    }
+
+    // ---- 快照用：标量槽按名字持久化，重启后注册顺序变了也能对上 ----
+    static std::vector<std::string> scalarNames();      // 下标即槽位
+    static int findScalar(const std::string& name);     // 未注册返回 -1
+
+private:
+    enum class Kind { Scalar, Object };
+    static uint32_t registerSlot(const std::string& name, Kind kind);
+};
+
+// shared_ptr 的原子读写：C++20 用 std::atomic<shared_ptr>，C++17 退回 atomic_load/atomic_store
+class AtomicSharedPtr {
+public:
+    std::shared_ptr<const void> load() const {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        return m_ptr.load(std::memory_order_acquire);
+#else
+        return std::atomic_load_explicit(&m_ptr, std::memory_order_acquire);
+#endif
+    }
+
+    void store(std::shared_ptr<const void> p) {
+#if defined(__cpp_lib_atomic_shared_ptr)
+        m_ptr.store(std::move(p), std::memory_order_release);
+#else
+        std::atomic_store_explicit(&m_ptr, std::move(p), std::memory_order_release);
+#endif
+    }
+
+private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<const void>> m_ptr;
+#else
+    std::shared_ptr<const void> m_ptr;
+#endif
+};
+
+// Session 内联存放的槽位
+class SessionSlotStorage {
+public:
+    template <class T>
+    void set(ScalarSlot<T> slot, T value) {
+        uint64_t raw = 0;
+        std::memcpy(&raw, &value, sizeof(T));
+        m_scalars[slot.index].store(raw, std::memory_order_relaxed);
+        m_scalarMask.fetch_or(1u << slot.index, std::memory_order_release);
+    }
+
+    template <class T>
+    T get(ScalarSlot<T> slot) const {
+        uint64_t raw = m_scalars[slot.index].load(std::memory_order_relaxed);
+        T value;
+        std::memcpy(&value, &raw, sizeof(T));
+        return value;
+    }
+
+    template <class T>
+    bool has(ScalarSlot<T> slot) const {
+        return m_scalarMask.load(std::memory_order_acquire) & (1u << slot.index);
+    }
+
+    template <class T>
+    void set(ObjectSlot<T> slot, std::shared_ptr<const T> value) {
+        m_objects[slot.index].store(std::move(value));
+    }
+
+    template <class T>
+    std::shared_ptr<const T> get(ObjectSlot<T> slot) const {
+        return std::static_pointer_cast<const T>(m_objects[slot.index].load());
+    }
+
+    template <class T>
+    bool has(ObjectSlot<T> slot) const {
+        return m_objects[slot.index].load() != nullptr;
+    }
+
+    // ---- 快照读写：按原始 64 位值访问标量槽 ----
+    uint32_t scalarMask() const { return m_scalarMask.load(std::memory_order_acquire); }
+    uint64_t rawScalar(uint32_t index) const { return m_scalars[index].load(std::memory_order_relaxed); }
+    void restoreScalar(uint32_t index, uint64_t raw) {
+        m_scalars[index].store(raw, std::memory_order_relaxed);
+        m_scalarMask.fetch_or(1u << index, std::memory_order_release);
+    }
+
+private:
+    std::atomic<uint64_t> m_scalars[SessionSlots::kMaxScalarSlots] = {};
+    std::atomic<uint32_t> m_scalarMask{0};
+    AtomicSharedPtr m_objects[SessionSlots::kMaxObjectSlots];
+};
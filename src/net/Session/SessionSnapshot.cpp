@@ -0,0 +1,195 @@
+#include "SessionSnapshot.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char kMagic[8] = {'L', 'S', 'S', 'N', 'A', 'P', '0', '1'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t reserved;          // 旧版本的 nextSessionId；id 改为随机分配后不再使用，写 0
+    uint64_t count;
+    int64_t maxExpiresAtWallMs;
+    uint32_t scalarSlots;
+    uint32_t nameBytes;         // 名字表字节数（已补齐到 8）
+};
+
+static_assert(sizeof(Header) % 8 == 0, "header must keep records 8-byte aligned");
+static_assert(sizeof(SessionSnapshot::Record) % 8 == 0, "record must be 8-byte aligned");
+
+size_t align8(size_t n) {
+    return (n + 7) & ~size_t(7);
+}
+}
+
+bool SessionSnapshot::write(const std::string& path,
+                            const std::vector<std::string>& scalarNames,
+                            std::vector<Record> records) {
+    std::sort(records.begin(), records.end(),
+              [](const Record& a, const Record& b) { return a.id < b.id; });
+
+    size_t nameBytes = 0;
+    for (const auto& name : scalarNames) {
+        nameBytes += 1 + std::min<size_t>(name.size(), 255);
+    }
+    nameBytes = align8(nameBytes);
+    size_t length = sizeof(Header) + nameBytes + records.size() * sizeof(Record);
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("snapshot open failed, path={}, err={}", tmp, std::strerror(errno));
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+        LOG_ERROR("snapshot ftruncate failed, path={}, err={}", tmp, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERROR("snapshot mmap failed, path={}, err={}", tmp, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    auto* out = static_cast<unsigned char*>(base);
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(Record);
+    header.count = records.size();
+    header.scalarSlots = static_cast<uint32_t>(scalarNames.size());
+    header.nameBytes = static_cast<uint32_t>(nameBytes);
+    for (const auto& r : records) {
+        header.maxExpiresAtWallMs = std::max(header.maxExpiresAtWallMs, r.expiresAtWallMs);
+    }
+    std::memcpy(out, &header, sizeof(header));
+
+    unsigned char* names = out + sizeof(Header);
+    for (const auto& name : scalarNames) {
+        size_t len = std::min<size_t>(name.size(), 255);
+        *names++ = static_cast<unsigned char>(len);
+        std::memcpy(names, name.data(), len);
+        names += len;
+    }
+    if (!records.empty()) {
+        std::memcpy(out + sizeof(Header) + nameBytes, records.data(), records.size() * sizeof(Record));
+    }
+
+    bool ok = ::msync(base, length, MS_SYNC) == 0;
+    ::munmap(base, length);
+    ::close(fd);
+
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("snapshot commit failed, path={}, err={}", path, std::strerror(errno));
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<SessionSnapshot> SessionSnapshot::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            LOG_WARN("snapshot open failed, path={}, err={}", path, std::strerror(errno));
+        }
+        return nullptr;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        LOG_WARN("snapshot too small, path={}", path);
+        ::close(fd);
+        return nullptr;
+    }
+
+    size_t length = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        LOG_WARN("snapshot mmap failed, path={}, err={}", path, std::strerror(errno));
+        return nullptr;
+    }
+
+    std::unique_ptr<SessionSnapshot> snap(new SessionSnapshot());
+    snap->m_base = base;
+    snap->m_length = length;
+
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    const auto* bytes = static_cast<const unsigned char*>(base);
+    size_t recordsOffset = sizeof(Header) + header.nameBytes;
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion ||
+        header.recordSize != sizeof(Record) ||
+        header.nameBytes % 8 != 0 ||
+        recordsOffset > length ||
+        header.count > (length - recordsOffset) / sizeof(Record)) {
+        LOG_WARN("snapshot format mismatch, ignored, path={}", path);
+        return nullptr;
+    }
+
+    // 名字表 -> 当前进程的槽位
+    const unsigned char* p = bytes + sizeof(Header);
+    const unsigned char* end = p + header.nameBytes;
+    for (uint32_t i = 0; i < header.scalarSlots; ++i) {
+        if (p >= end || p + 1 + *p > end) {
+            LOG_WARN("snapshot name table corrupted, path={}", path);
+            return nullptr;
+        }
+        std::string name(reinterpret_cast<const char*>(p + 1), *p);
+        p += 1 + *p;
+        snap->m_remap.push_back(SessionSlots::findScalar(name));
+    }
+
+    snap->m_maxExpiresAtWallMs = header.maxExpiresAtWallMs;
+    snap->m_records = reinterpret_cast<const Record*>(bytes + recordsOffset);
+    snap->m_count = header.count;
+
+    // 🔑 只建立映射，不预读；恢复时按需缺页，启动耗时与快照大小无关
+    ::madvise(base, length, MADV_RANDOM);
+    return snap;
+}
+
+SessionSnapshot::~SessionSnapshot() {
+    if (m_base) {
+        ::munmap(m_base, m_length);
+    }
+}
+
+int64_t SessionSnapshot::maxExpiresAtWallMs() const {
+    return m_maxExpiresAtWallMs;
+}
+
+size_t SessionSnapshot::size() const {
+    return m_count;
+}
+
+const SessionSnapshot::Record& SessionSnapshot::record(size_t index) const {
+    return m_records[index];
+}
+
+size_t SessionSnapshot::find(uint64_t id) const {
+    const Record* end = m_records + m_count;
+    const Record* it = std::lower_bound(m_records, end, id,
+        [](const Record& r, uint64_t key) { return r.id < key; });
+    return (it != end && it->id == id) ? static_cast<size_t>(it - m_records) : npos;
+}
+
+int SessionSnapshot::remapScalar(uint32_t snapshotIndex) const {
+    return snapshotIndex < m_remap.size() ? m_remap[snapshotIndex] : -1;
+}
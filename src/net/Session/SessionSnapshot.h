@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SessionSlots.h"
+
+// Session 表的二进制快照，用于热重启：停服时写出，启动时 mmap 打开后按需恢复。
+// 文件布局（小端，8 字节对齐）：
+//   Header | 标量槽名字表（每个：uint8 长度 + 字节，整体补齐到 8）| Record × count（按 id 升序）
+// 只保存可以按值恢复的数据：id、过期时间、TTL、标量槽；对象槽和字符串 key 数据不保存。
+class SessionSnapshot {
+public:
+    struct Record {
+        uint64_t id;
+        int64_t expiresAtWallMs;    // 墙上时间，跨进程有效
+        uint64_t ttlMs;             // Session::ttlMs()，0 表示默认 TTL
+        uint64_t scalarMask;
+        uint64_t scalars[SessionSlots::kMaxScalarSlots];
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // 先写 path.tmp 再 rename，中途崩溃不会留下半个文件
+    static bool write(const std::string& path,
+                      const std::vector<std::string>& scalarNames,
+                      std::vector<Record> records);
+
+    // mmap 打开并校验格式；文件不存在或损坏时返回 nullptr
+    static std::unique_ptr<SessionSnapshot> open(const std::string& path);
+
+    ~SessionSnapshot();
+    SessionSnapshot(const SessionSnapshot&) = delete;
+    SessionSnapshot& operator=(const SessionSnapshot&) = delete;
+
+    int64_t maxExpiresAtWallMs() const;
+    size_t size() const;
+    const Record& record(size_t index) const;
+
+    // 按 id 二分查找，返回下标或 npos
+    size_t find(uint64_t id) const;
+
+    // 快照中的标量槽下标 -> 当前进程中同名槽的下标，未注册时为 -1
+    int remapScalar(uint32_t snapshotIndex) const;
+
+private:
+    SessionSnapshot() = default;
+
+    void* m_base = nullptr;
+    size_t m_length = 0;
+    int64_t m_maxExpiresAtWallMs = 0;
+    const Record* m_records = nullptr;
+    size_t m_count = 0;
+    std::vector<int> m_remap;
+};
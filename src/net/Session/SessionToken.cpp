@@ -0,0 +1,130 @@
+#include "SessionToken.h"
+#include "Logger.h"
+#include <cstring>
+#include <random>
+
+namespace {
+inline uint64_t rotl(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+inline void sipround(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+    v0 += v1; v1 = rotl(v1, 13); v1 ^= v0; v0 = rotl(v0, 32);
+    v2 += v3; v3 = rotl(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotl(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotl(v1, 17); v1 ^= v2; v2 = rotl(v2, 32);
+}
+
+inline uint64_t load64le(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+void appendHex(std::string& out, uint64_t v) {
+    static const char kDigits[] = "0123456789abcdef";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        out += kDigits[(v >> shift) & 0xF];
+    }
+}
+
+// 固定 16 位十六进制
+bool parseHex(std::string_view s, uint64_t& out) {
+    if (s.size() != 16) return false;
+    uint64_t v = 0;
+    for (char c : s) {
+        int d;
+        if (c >= '0' && c <= '9') d = c - '0';
+        else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else return false;
+        v = (v << 4) | static_cast<uint64_t>(d);
+    }
+    out = v;
+    return true;
+}
+}
+
+uint64_t SessionToken::siphash24(uint64_t k0, uint64_t k1, const void* data, size_t len) {
+    const unsigned char* in = static_cast<const unsigned char*>(data);
+    uint64_t v0 = 0x736f6d6570736575ull ^ k0;
+    uint64_t v1 = 0x646f72616e646f6dull ^ k1;
+    uint64_t v2 = 0x6c7967656e657261ull ^ k0;
+    uint64_t v3 = 0x7465646279746573ull ^ k1;
+
+    const unsigned char* end = in + (len & ~size_t(7));
+    for (; in != end; in += 8) {
+        uint64_t m = load64le(in);
+        v3 ^= m;
+        sipround(v0, v1, v2, v3);
+        sipround(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    uint64_t b = static_cast<uint64_t>(len) << 56;
+    for (size_t i = 0; i < (len & 7); ++i) {
+        b |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    v3 ^= b;
+    sipround(v0, v1, v2, v3);
+    sipround(v0, v1, v2, v3);
+    v0 ^= b;
+
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) sipround(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+SessionToken::SessionToken(const std::string& secret, std::string_view purpose) {
+    if (secret.empty()) {
+        std::random_device rd;
+        m_k0 = (static_cast<uint64_t>(rd()) << 32) | rd();
+        m_k1 = (static_cast<uint64_t>(rd()) << 32) | rd();
+        LOG_WARN("No resume token secret configured, using a random key (tokens will not survive restarts)");
+        return;
+    }
+    // 任意长度的 secret 派生出 128 位密钥
+    m_k0 = siphash24(0, 0, secret.data(), secret.size());
+    m_k1 = siphash24(0, 1, secret.data(), secret.size());
+    if (!purpose.empty()) {
+        uint64_t k0 = m_k0;
+        m_k0 = siphash24(k0, m_k1, purpose.data(), purpose.size());
+        m_k1 = siphash24(m_k1, k0, purpose.data(), purpose.size());
+    }
+}
+
+uint64_t SessionToken::mac(uint64_t sessionId, uint64_t expiresAtSec) const {
+    unsigned char buf[16];
+    for (int i = 0; i < 8; ++i) {
+        buf[i] = static_cast<unsigned char>(sessionId >> (8 * i));
+        buf[8 + i] = static_cast<unsigned char>(expiresAtSec >> (8 * i));
+    }
+    return siphash24(m_k0, m_k1, buf, sizeof(buf));
+}
+
+std::string SessionToken::issue(uint64_t sessionId, uint64_t expiresAtSec) const {
+    std::string token;
+    token.reserve(50);
+    appendHex(token, sessionId);
+    token += '.';
+    appendHex(token, expiresAtSec);
+    token += '.';
+    appendHex(token, mac(sessionId, expiresAtSec));
+    return token;
+}
+
+std::optional<uint64_t> SessionToken::verify(std::string_view token, uint64_t nowSec) const {
+    uint64_t sid = 0, expires = 0, tag = 0;
+    if (token.size() != 50 || token[16] != '.' || token[33] != '.' ||
+        !parseHex(token.substr(0, 16), sid) ||
+        !parseHex(token.substr(17, 16), expires) ||
+        !parseHex(token.substr(34, 16), tag)) {
+        return std::nullopt;
+    }
+
+    // 🔑 常量时间比较，不泄露 mac 匹配了多少位
+    uint64_t diff = tag ^ mac(sid, expires);
+    if (diff != 0 || expires < nowSec) {
+        return std::nullopt;
+    }
+    return sid;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// 会话恢复令牌：sid.expires.mac（十六进制），mac = SipHash-2-4(key, sid || expires)。
+// 客户端重连时带上令牌即可找回原 Session（含缓存的登录状态），不必再查库认证。
+// 令牌只证明"持有者曾拥有该 Session"，不含任何用户数据。
+// 同一格式也用于登录票据（id 为用户 id，由认证服务用共享 secret 签发）；
+// purpose 参与密钥派生，不同用途的令牌互不通用，即使 secret 相同。
+class SessionToken {
+public:
+    // secret 为空时使用随机密钥（进程重启后旧令牌全部失效）
+    explicit SessionToken(const std::string& secret = {}, std::string_view purpose = {});
+
+    std::string issue(uint64_t sessionId, uint64_t expiresAtSec) const;
+
+    // 校验签名和有效期，成功时返回 session id
+    std::optional<uint64_t> verify(std::string_view token, uint64_t nowSec) const;
+
+    static uint64_t siphash24(uint64_t k0, uint64_t k1, const void* data, size_t len);
+
+private:
+    uint64_t mac(uint64_t sessionId, uint64_t expiresAtSec) const;
+
+    uint64_t m_k0;
+    uint64_t m_k1;
+};
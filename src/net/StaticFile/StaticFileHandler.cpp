@@ -0,0 +1,372 @@
+// StaticFile/StaticFileHandler.cpp
+#include "StaticFileHandler.h"
+#include "Logger.h"
+#include "Thread_pool.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstdio>
+
+namespace http = boost::beast::http;
+
+namespace {
+struct MimeType {
+    std::string_view ext;
+    std::string_view type;
+};
+
+constexpr MimeType kMimeTypes[] = {
+    {".html", "text/html; charset=utf-8"},
+    {".htm", "text/html; charset=utf-8"},
+    {".css", "text/css; charset=utf-8"},
+    {".js", "application/javascript; charset=utf-8"},
+    {".mjs", "application/javascript; charset=utf-8"},
+    {".json", "application/json"},
+    {".map", "application/json"},
+    {".txt", "text/plain; charset=utf-8"},
+    {".svg", "image/svg+xml"},
+    {".png", "image/png"},
+    {".jpg", "image/jpeg"},
+    {".jpeg", "image/jpeg"},
+    {".gif", "image/gif"},
+    {".webp", "image/webp"},
+    {".ico", "image/x-icon"},
+    {".woff", "font/woff"},
+    {".woff2", "font/woff2"},
+    {".wasm", "application/wasm"},
+};
+
+std::string_view mimeType(std::string_view path) {
+    size_t dot = path.rfind('.');
+    if (dot == std::string_view::npos) return "application/octet-stream";
+    std::string_view ext = path.substr(dot);
+    for (const auto& m : kMimeTypes) {
+        if (m.ext.size() != ext.size()) continue;
+        bool same = true;
+        for (size_t i = 0; i < ext.size() && same; ++i) {
+            same = std::tolower(static_cast<unsigned char>(ext[i])) == m.ext[i];
+        }
+        if (same) return m.type;
+    }
+    return "application/octet-stream";
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool urlDecode(std::string_view in, std::string& out) {
+    out.clear();
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        char c = in[i];
+        if (c == '%') {
+            if (i + 2 >= in.size()) return false;
+            int hi = hexValue(in[i + 1]);
+            int lo = hexValue(in[i + 2]);
+            if (hi < 0 || lo < 0) return false;
+            c = static_cast<char>(hi * 16 + lo);
+            i += 2;
+        }
+        if (c == '\0') return false;
+        out.push_back(c);
+    }
+    return true;
+}
+
+enum class RangeResult {
+    None,           // 没有 Range 或无法识别（按完整内容返回）
+    Satisfiable,
+    Unsatisfiable
+};
+
+// 只支持单区间："bytes=a-b" / "bytes=a-" / "bytes=-n"
+RangeResult parseRange(std::string_view header, uint64_t size, uint64_t& start, uint64_t& length) {
+    constexpr std::string_view prefix = "bytes=";
+    if (header.substr(0, prefix.size()) != prefix) return RangeResult::None;
+    std::string_view spec = header.substr(prefix.size());
+    if (spec.find(',') != std::string_view::npos) return RangeResult::None;
+
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) return RangeResult::None;
+
+    auto parseNumber = [](std::string_view s, uint64_t& v) {
+        if (s.empty() || s.size() > 19) return false;
+        v = 0;
+        for (char c : s) {
+            if (c < '0' || c > '9') return false;
+            v = v * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    };
+
+    std::string_view first = spec.substr(0, dash);
+    std::string_view last = spec.substr(dash + 1);
+    uint64_t a = 0, b = 0;
+
+    if (first.empty()) {
+        // 后缀区间：最后 n 个字节
+        if (!parseNumber(last, b)) return RangeResult::None;
+        if (b == 0 || size == 0) return RangeResult::Unsatisfiable;
+        length = std::min(b, size);
+        start = size - length;
+        return RangeResult::Satisfiable;
+    }
+
+    if (!parseNumber(first, a)) return RangeResult::None;
+    if (a >= size) return RangeResult::Unsatisfiable;
+    if (last.empty()) {
+        b = size - 1;
+    } else {
+        if (!parseNumber(last, b) || b < a) return RangeResult::None;
+        b = std::min(b, size - 1);
+    }
+    start = a;
+    length = b - a + 1;
+    return RangeResult::Satisfiable;
+}
+
+bool etagMatches(std::string_view ifNoneMatch, std::string_view etag) {
+    if (ifNoneMatch.empty()) return false;
+    if (ifNoneMatch == "*") return true;
+    // 可能是逗号分隔的列表
+    size_t pos = 0;
+    while (pos < ifNoneMatch.size()) {
+        size_t comma = ifNoneMatch.find(',', pos);
+        std::string_view tag = ifNoneMatch.substr(pos, comma == std::string_view::npos ? comma : comma - pos);
+        while (!tag.empty() && tag.front() == ' ') tag.remove_prefix(1);
+        while (!tag.empty() && tag.back() == ' ') tag.remove_suffix(1);
+        if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+        std::string_view ours = etag.substr(0, 2) == "W/" ? etag.substr(2) : etag;
+        if (tag == ours) return true;
+        if (comma == std::string_view::npos) break;
+        pos = comma + 1;
+    }
+    return false;
+}
+
+template <class Message>
+void setEntityHeaders(Message& msg, std::string_view etag, std::string_view contentType) {
+    msg.set(http::field::etag, boost::beast::string_view(etag.data(), etag.size()));
+    msg.set(http::field::content_type, boost::beast::string_view(contentType.data(), contentType.size()));
+    msg.set(http::field::accept_ranges, "bytes");
+}
+
+std::string contentRange(uint64_t start, uint64_t length, uint64_t size) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "bytes %llu-%llu/%llu",
+                  static_cast<unsigned long long>(start),
+                  static_cast<unsigned long long>(start + length - 1),
+                  static_cast<unsigned long long>(size));
+    return buf;
+}
+
+void sendNotModified(const HttpResponder& res, std::string_view etag) {
+    HttpResponse r;
+    r.result(http::status::not_modified);
+    r.set(http::field::etag, boost::beast::string_view(etag.data(), etag.size()));
+    res.send(std::move(r));
+}
+
+void sendUnsatisfiable(const HttpResponder& res, uint64_t size) {
+    HttpResponse r;
+    r.result(http::status::range_not_satisfiable);
+    r.set(http::field::content_range, "bytes */" + std::to_string(size));
+    res.send(std::move(r));
+}
+}
+
+StaticFileHandler::StaticFileHandler(Options options)
+    : m_options(std::move(options)) {
+    while (m_options.root.size() > 1 && m_options.root.back() == '/') {
+        m_options.root.pop_back();
+    }
+    LOG_INFO("Created, root={}, max_cached_file_size={}, max_cache_bytes={}",
+             m_options.root, m_options.maxCachedFileSize, m_options.maxCacheBytes);
+}
+
+void StaticFileHandler::mount(HttpRouter& router, const std::string& prefix,
+                              const std::shared_ptr<StaticFileHandler>& handler) {
+    std::string path = prefix;
+    while (!path.empty() && path.back() == '/') path.pop_back();
+    path += "/*path";
+
+    router.get(path, [handler](const HttpRequest& req, const RouteParams& params, const HttpResponder& res) {
+        handler->handle(req, params, res);
+    });
+    LOG_INFO("Static files mounted at {}", path);
+}
+
+void StaticFileHandler::handle(const HttpRequest& req, const RouteParams& params, const HttpResponder& res) {
+    RequestInfo info;
+    if (!resolvePath(params.get("path"), info.path)) {
+        res.send(http::status::bad_request, "Bad Request");
+        return;
+    }
+
+    auto inm = req[http::field::if_none_match];
+    info.ifNoneMatch.assign(inm.data(), inm.size());
+    auto range = req[http::field::range];
+    info.range.assign(range.data(), range.size());
+
+    // 热路径：缓存命中且仍新鲜时直接在 loop 上应答（304 或内存中的小文件）
+    if (auto entry = lookup(info.path)) {
+        if (serveCached(entry, info, res)) return;
+    }
+
+    // 其余情况（未缓存/需重新 stat/大文件需要 open）交给 ThreadPool
+    auto self = shared_from_this();
+    ThreadPool::detach_task([self, info = std::move(info), res]() {
+        self->serveFromDisk(info, res);
+    });
+}
+
+bool StaticFileHandler::resolvePath(std::string_view relative, std::string& out) const {
+    std::string decoded;
+    if (!urlDecode(relative, decoded)) return false;
+
+    // 拒绝任何 ".." 段，防止跳出 root
+    size_t pos = 0;
+    while (pos <= decoded.size()) {
+        size_t slash = decoded.find('/', pos);
+        std::string_view seg(decoded.data() + pos,
+                             (slash == std::string::npos ? decoded.size() : slash) - pos);
+        if (seg == "..") return false;
+        if (slash == std::string::npos) break;
+        pos = slash + 1;
+    }
+
+    out = m_options.root;
+    if (!decoded.empty() && decoded.front() != '/') out.push_back('/');
+    out += decoded;
+    return true;
+}
+
+StaticFileHandler::EntryPtr StaticFileHandler::lookup(const std::string& path) const {
+    std::shared_lock lock(m_mutex);
+    auto it = m_cache.find(path);
+    if (it == m_cache.end()) return nullptr;
+
+    auto age = std::chrono::steady_clock::now() - it->second->checkedAt;
+    if (age > std::chrono::milliseconds(m_options.revalidateMs)) return nullptr;
+    return it->second;
+}
+
+void StaticFileHandler::store(const std::string& path, const EntryPtr& entry) {
+    std::unique_lock lock(m_mutex);
+    auto& slot = m_cache[path];
+    if (slot && slot->content) m_cachedBytes -= slot->content->size();
+    if (entry->content) m_cachedBytes += entry->content->size();
+    slot = entry;
+
+    if (m_cachedBytes > m_options.maxCacheBytes) {
+        // 超出上限时整体清空，下次访问重新加载
+        LOG_INFO("Static cache over limit ({} bytes), clearing", m_cachedBytes);
+        m_cache.clear();
+        m_cachedBytes = 0;
+    }
+}
+
+bool StaticFileHandler::serveCached(const EntryPtr& entry, const RequestInfo& info,
+                                    const HttpResponder& res) const {
+    if (etagMatches(info.ifNoneMatch, entry->etag)) {
+        sendNotModified(res, entry->etag);
+        return true;
+    }
+    if (!entry->content) return false;
+
+    uint64_t start = 0, length = entry->size;
+    HttpResponse r;
+    switch (parseRange(info.range, entry->size, start, length)) {
+    case RangeResult::Unsatisfiable:
+        sendUnsatisfiable(res, entry->size);
+        return true;
+    case RangeResult::Satisfiable:
+        r.result(http::status::partial_content);
+        r.set(http::field::content_range, contentRange(start, length, entry->size));
+        break;
+    case RangeResult::None:
+        start = 0;
+        length = entry->size;
+        r.result(http::status::ok);
+        break;
+    }
+
+    setEntityHeaders(r, entry->etag, entry->contentType);
+    r.body().assign(entry->content->data() + start, static_cast<size_t>(length));
+    res.send(std::move(r));
+    return true;
+}
+
+void StaticFileHandler::serveFromDisk(const RequestInfo& info, const HttpResponder& res) {
+    std::string path = info.path;
+    struct stat st {};
+    if (::stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        if (path.back() != '/') path.push_back('/');
+        path += m_options.indexFile;
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || ::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (fd >= 0) ::close(fd);
+        res.send(http::status::not_found, "Not Found");
+        return;
+    }
+    auto file = std::make_shared<const FileHandle>(fd);
+
+    auto entry = std::make_shared<Entry>();
+    entry->path = path;
+    entry->size = static_cast<uint64_t>(st.st_size);
+    entry->contentType = mimeType(path);
+    entry->checkedAt = std::chrono::steady_clock::now();
+
+    char etag[64];
+    std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+                  static_cast<unsigned long long>(st.st_size),
+                  static_cast<unsigned long long>(st.st_mtim.tv_sec) * 1000000000ull +
+                      static_cast<unsigned long long>(st.st_mtim.tv_nsec));
+    entry->etag = etag;
+
+    if (entry->size <= m_options.maxCachedFileSize) {
+        auto content = std::make_shared<std::string>(static_cast<size_t>(entry->size), '\0');
+        size_t done = 0;
+        while (done < content->size()) {
+            ssize_t n = ::pread(fd, content->data() + done, content->size() - done, static_cast<off_t>(done));
+            if (n <= 0) break;
+            done += static_cast<size_t>(n);
+        }
+        if (done == content->size()) {
+            entry->content = std::move(content);
+        }
+    }
+
+    store(info.path, entry);
+    if (serveCached(entry, info, res)) return;
+
+    // 大文件：sendfile 发送
+    uint64_t start = 0, length = entry->size;
+    HttpFileHeader header;
+    switch (parseRange(info.range, entry->size, start, length)) {
+    case RangeResult::Unsatisfiable:
+        sendUnsatisfiable(res, entry->size);
+        return;
+    case RangeResult::Satisfiable:
+        header.result(http::status::partial_content);
+        header.set(http::field::content_range, contentRange(start, length, entry->size));
+        break;
+    case RangeResult::None:
+        start = 0;
+        length = entry->size;
+        header.result(http::status::ok);
+        break;
+    }
+    setEntityHeaders(header, entry->etag, entry->contentType);
+
+    // 文件内容由连接在 ThreadPool 上按块预取，sendfile 只发已进入 page cache 的部分
+    res.sendFile(std::move(header), std::move(file), start, length);
+}
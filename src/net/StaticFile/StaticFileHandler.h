@@ -0,0 +1,67 @@
+// StaticFile/StaticFileHandler.h
+#pragma once
+#include <chrono>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "HttpRouter.h"
+
+// 静态文件服务（web 客户端 bundle）。
+// - 元数据（大小、mtime、ETag、Content-Type）和小文件内容缓存在内存中
+// - If-None-Match 命中时直接返回 304
+// - 支持单区间 Range 请求（206 / 416）
+// - 大文件通过 HttpResponder::sendFile 用 sendfile 零拷贝发送，连接先在 ThreadPool 上按块预取
+// - stat/open/read 等磁盘操作都在 ThreadPool 中完成，不阻塞 event loop
+class StaticFileHandler : public std::enable_shared_from_this<StaticFileHandler> {
+public:
+    struct Options {
+        std::string root;                           // 文件根目录
+        std::string indexFile = "index.html";       // 请求目录时返回的文件
+        size_t maxCachedFileSize = 64 * 1024;       // 不超过该大小的文件内容缓存在内存
+        size_t maxCacheBytes = 64 * 1024 * 1024;    // 内存中缓存的文件内容总上限
+        size_t revalidateMs = 2000;                 // 缓存项超过该时间后重新 stat
+    };
+
+    explicit StaticFileHandler(Options options);
+
+    // 在 router 上注册 GET <prefix>/*path
+    static void mount(HttpRouter& router, const std::string& prefix,
+                      const std::shared_ptr<StaticFileHandler>& handler);
+
+    void handle(const HttpRequest& req, const RouteParams& params, const HttpResponder& res);
+
+private:
+    struct Entry {
+        std::string path;       // 实际文件路径（目录请求时为 index 文件）
+        uint64_t size = 0;
+        std::string etag;
+        std::string_view contentType;
+        std::shared_ptr<const std::string> content;     // 小文件内容，大文件为空
+        std::chrono::steady_clock::time_point checkedAt;
+    };
+    using EntryPtr = std::shared_ptr<const Entry>;
+
+    // 异步处理需要的请求字段拷贝
+    struct RequestInfo {
+        std::string path;
+        std::string ifNoneMatch;
+        std::string range;
+    };
+
+    bool resolvePath(std::string_view relative, std::string& out) const;
+    EntryPtr lookup(const std::string& path) const;
+    void store(const std::string& path, const EntryPtr& entry);
+
+    void serveFromDisk(const RequestInfo& info, const HttpResponder& res);
+    bool serveCached(const EntryPtr& entry, const RequestInfo& info, const HttpResponder& res) const;
+
+private:
+    Options m_options;
+
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, EntryPtr> m_cache;
+    size_t m_cachedBytes = 0;
+};